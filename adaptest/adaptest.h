@@ -60,17 +60,46 @@
 #define ADAPTEST_FORMATED_BUFLEN 256
 #endif
 
-#include <map>
-#include <list>
-#include <sstream>
-#include <string>
+// use threads for --repeat-parallel, requires C++11
+#ifndef ADAPTEST_THREADS
+#if __cplusplus >= 201103L
+#define ADAPTEST_THREADS 1
+#else
+#define ADAPTEST_THREADS 0
+#endif
+#endif
 
-#if ADAPTEST_DEFAULT_LOGGER
-#include <iostream>
-#include <iomanip>
+// size of one block of the arena which stores failed CHECK()s. a testcase
+// only allocates a new block when its failure messages exceed this size.
+#ifndef ADAPTEST_CHECK_ARENA_BLOCKSIZE
+#define ADAPTEST_CHECK_ARENA_BLOCKSIZE 4096
 #endif
 
-#include <cstdio>
+// build throughput mode: if set to one the testsuite translation units only
+// get the testcase classes and the declarations of the runner, the registry
+// and the string formatter, without the container and stream headers.
+// adaptest/runner.h is left out, exactly one translation unit defines
+// ADAPTEST_RUNNER before including this header and compiles it, see
+// adaptest/runner.cpp. requires C++11.
+#ifndef ADAPTEST_LEAN
+#define ADAPTEST_LEAN 0
+#endif
+
+#if !ADAPTEST_LEAN
+#define ADAPTEST_RUNNER_DEFINITIONS 1
+#define ADAPTEST_RUNNER_INLINE inline
+#elif defined(ADAPTEST_RUNNER)
+#define ADAPTEST_RUNNER_DEFINITIONS 1
+#define ADAPTEST_RUNNER_INLINE
+#else
+#define ADAPTEST_RUNNER_DEFINITIONS 0
+#define ADAPTEST_RUNNER_INLINE
+#endif
+
+#include <iosfwd>
+#include <string>
+
+#include <cstring>
 
 using std::string;
 using std::stringstream;
@@ -111,56 +140,276 @@ namespace ADAPTEST_NAMESPACE {
   // Simple String Formatter
   // -----------------------
 
-  template <class A, class B, class C, class D, class E>
-  string 
-  format(string fmt, const A& a, const B& b, const C& c, const D& d, const E& e) 
-  {
-    stringstream output;
-    size_t offset = 0;
-    size_t param  = -1;
-    size_t find   = 0;
-    while ((find = fmt.find('{', offset)) != string::npos) {
-        output << fmt.substr(offset, find - offset);
-        offset = find + 1;
-        char selection = fmt[offset];
-        if ((selection >= '0') && (selection < '5')) {
-            offset++;
-            param = (size_t) selection - '0';
-        } else if (selection == '}') {
-            param++;
-        } else {
-            offset = fmt.find('}', offset) + 1;
-            continue;
-        }
-        switch (param) {
-            case 0: output << a; break;
-            case 1: output << b; break;
-            case 2: output << c; break;
-            case 3: output << d; break;
-            case 4: output << e; break;
-            default: break;
-        }
-        offset++;
-    }
-    output << fmt.substr(offset, fmt.length() - offset);
-    return output.str();
-  }
-  
+  // the arguments are passed to the runner type erased, so only the runner
+  // parses the format string and testsuites do not need the stream headers
+
+  template <class T>
+  void write_value(std::ostream& out, const void* value)
+  { out << *static_cast<const T*>(value); }
+
+  ADAPTEST_RUNNER_INLINE
+  void write_cstring(std::ostream& out, const void* value);
+
+  class FormatArg {
+  private:
+    const void* value;
+    void (*writer)(std::ostream& out, const void* value);
+  public:
+    template <class T>
+    FormatArg(const T& _value) : value(&_value), writer(&write_value<T>) {}
+
+    FormatArg(const char* _value) : value(_value), writer(&write_cstring) {}
+
+    void write(std::ostream& out) const { writer(out, value); }
+  };
+
+  // replaces "{}" by the next and "{0}" .. "{4}" by the given argument
+  ADAPTEST_RUNNER_INLINE
+  string format_args(const string& fmt, const FormatArg* args, size_t count);
+
   template <class A>
   string format(string fmt, const A& a)
-  { return format(fmt, a, "", "", "", ""); }
+  {
+    const FormatArg args[] = { a };
+    return format_args(fmt, args, 1);
+  }
 
   template <class A, class B>
   string format(string fmt, const A& a, const B& b)
-  { return format(fmt, a, b, "", "", ""); }
+  {
+    const FormatArg args[] = { a, b };
+    return format_args(fmt, args, 2);
+  }
 
   template <class A, class B, class C>
   string format(string fmt, const A& a, const B& b, const C& c)
-  { return format(fmt, a, b, c, "", ""); }
+  {
+    const FormatArg args[] = { a, b, c };
+    return format_args(fmt, args, 3);
+  }
 
   template <class A, class B, class C, class D>
   string format(string fmt, const A& a, const B& b, const C& c, const D& d)
-  { return format(fmt, a, b, c, d, ""); }
+  {
+    const FormatArg args[] = { a, b, c, d };
+    return format_args(fmt, args, 4);
+  }
+
+  template <class A, class B, class C, class D, class E>
+  string 
+  format(string fmt, const A& a, const B& b, const C& c, const D& d, const E& e) 
+  {
+    const FormatArg args[] = { a, b, c, d, e };
+    return format_args(fmt, args, 5);
+  }
+
+  // Build Throughput
+  // ----------------
+
+  // the writers of common types are compiled once by the runner in build
+  // throughput mode. testsuite translation units which format other types
+  // have to include <ostream> themselves.
+
+  #define ADAPTEST_INSTANCE_TYPES(X)                                           \
+    X(bool) X(char) X(signed char) X(unsigned char) X(short)                   \
+    X(unsigned short) X(int) X(unsigned int) X(long) X(unsigned long)          \
+    X(long long) X(unsigned long long) X(float) X(double) X(long double)       \
+    X(std::string)
+
+  #if ADAPTEST_LEAN
+  #define ADAPTEST_INSTANCE(T)                                                 \
+    template <> void write_value<T>(std::ostream& out, const void* value);
+  ADAPTEST_INSTANCE_TYPES(ADAPTEST_INSTANCE)
+  #undef ADAPTEST_INSTANCE
+  #endif // ADAPTEST_LEAN
+
+  // ================================================================
+
+  // Soft Assertion Storage
+  // ----------------------
+
+  // bump allocator for the failures of CHECK(). memory is only given back
+  // upon destruction, reset() merely rewinds the arena so the next testcase
+  // reuses the blocks of the previous one.
+  class CheckArena {
+  private:
+    struct Block {
+      Block* next;
+      size_t size;
+      size_t used;
+      char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    Block* first;
+    Block* current;
+
+    static size_t align(size_t size) {
+      const size_t a = sizeof(void*) > sizeof(double) 
+                     ? sizeof(void*) : sizeof(double);
+      return (size + a - 1) & ~(a - 1);
+    }
+
+    static Block* newBlock(size_t size) {
+      Block* block = reinterpret_cast<Block*>(
+        new char[align(sizeof(Block)) + size]);
+      block->next = 0;
+      block->size = size;
+      block->used = 0;
+      return block;
+    }
+
+    CheckArena(const CheckArena&);
+    CheckArena& operator = (const CheckArena&);
+
+  public:
+    CheckArena() : first(0), current(0) {}
+
+    ~CheckArena() {
+      while (first) {
+        Block* next = first->next;
+        delete[] reinterpret_cast<char*>(first);
+        first = next;
+      }
+    }
+
+    void* allocate(size_t size) {
+      size = align(size);
+
+      // advance through the blocks kept from previous testcases
+      while (current && current->used + size > current->size 
+             && current->next && current->next->size >= size) {
+        current = current->next;
+        current->used = 0;
+      }
+
+      if (!current || current->used + size > current->size) {
+        Block* block = newBlock(size > ADAPTEST_CHECK_ARENA_BLOCKSIZE 
+                                ? size : ADAPTEST_CHECK_ARENA_BLOCKSIZE);
+        if (!current) {
+          first = block;
+        } else {
+          block->next = current->next;
+          current->next = block;
+        }
+        current = block;
+      }
+
+      void* mem = current->data() + current->used;
+      current->used += size;
+      return mem;
+    }
+
+    const char* copy(const std::string& str) {
+      char* mem = static_cast<char*>(allocate(str.size() + 1));
+      std::memcpy(mem, str.c_str(), str.size() + 1);
+      return mem;
+    }
+
+    void reset() {
+      current = first;
+      if (current) current->used = 0;
+    }
+  };
+
+  // ----------------------------------------------------------------
+
+  // one failed CHECK() or note, allocated inside the CheckArena
+  struct CheckEntry {
+    ResultEnum resval;
+    int line;
+    const char* test;
+    const char* msg;
+    CheckEntry* next;
+
+    Result result() const { return Result(resval, test, line, msg); }
+  };
+
+  // ----------------------------------------------------------------
+
+  // the failures of all CHECK()s and the notes of the currently running 
+  // testcase
+  class CheckLog {
+  private:
+    struct List {
+      CheckEntry* first;
+      CheckEntry* last;
+      List() : first(0), last(0) {}
+    };
+
+    CheckArena arena;
+    List failed;
+    List notes;
+    size_t checks;
+    size_t failures;
+
+    void append(List& list, const Result& res) {
+      CheckEntry* entry = static_cast<CheckEntry*>(
+        arena.allocate(sizeof(CheckEntry)));
+      entry->resval = res.resval;
+      entry->line   = res.line;
+      entry->test   = arena.copy(res.test);
+      entry->msg    = arena.copy(res.msg);
+      entry->next   = 0;
+
+      if (list.last) list.last->next = entry;
+      else           list.first = entry;
+      list.last = entry;
+    }
+
+  public:
+    CheckLog() : checks(0), failures(0) {}
+
+    void add(const Result& res) {
+      checks++;
+      if (res.resval == OK) return;
+      append(failed, res);
+      failures++;
+    }
+
+    // count passed checks which were counted elsewhere
+    void add_passed(size_t count) {
+      checks += count;
+    }
+
+    // informational output of a testcase, p.e. measurements
+    void note(const Result& res) {
+      append(notes, res);
+    }
+
+    CheckEntry* getFailures() { return failed.first; }
+    CheckEntry* getNotes()    { return notes.first; }
+    size_t getChecks()        { return checks; }
+    size_t getFailed()        { return failures; }
+
+    // merge the failures into the result returned by Testcase::run()
+    Result aggregate(const Result& retval) {
+      if (!failures) return retval;
+
+      if (retval.resval != OK) {
+        return Result(retval.resval, retval.test, retval.line, format(
+          "{} ({} of {} checks failed before)", 
+          retval.msg, failures, checks));
+      }
+
+      ResultEnum resval = FAILED;
+      for (CheckEntry* f = failed.first; f; f = f->next) {
+        if (f->resval == ERROR) resval = ERROR;
+      }
+
+      CheckEntry* first = failed.first;
+      if (failures == 1) return first->result();
+
+      return Result(resval, first->test, first->line, format(
+        "{} of {} checks failed, first: {}", failures, checks, first->msg));
+    }
+
+    void reset() {
+      arena.reset();
+      failed = List();
+      notes = List();
+      checks = failures = 0;
+    }
+  };
 
   // ================================================================
 
@@ -178,6 +427,16 @@ namespace ADAPTEST_NAMESPACE {
     virtual void test_failed(Testcase& testcase, Result& res)=0;
     virtual void test_error(Testcase& testcase,  Result& res)=0;
 
+    // called for every failed CHECK() before the testcase result is logged
+    virtual void check_failed(Testcase&, Result&) {}
+
+    // called for every note of a testcase, p.e. measurements
+    virtual void test_info(Testcase&, Result&) {}
+
+    // called if an artifact of a testcase, p.e. a buffer dump, could not be 
+    // written after the testcase was already logged
+    virtual void artifact_error(Result&) {}
+
     // testsuite_start always is followed by a call to the same following object
     virtual void testsuite_start(TestsuiteBase& suite) = 0;
     virtual void testsuite_done(TestsuiteBase& suite) = 0;
@@ -185,6 +444,45 @@ namespace ADAPTEST_NAMESPACE {
     virtual int getFailed() = 0;
   };
 
+  // Run Observers
+  // -------------
+
+  // the phases of a testcase run
+  enum Phase { SETUP, RUN, TEARDOWN };
+
+  // notified around every phase of every testcase run, p.e. by profilers.
+  // unlike a Logger it is called from the thread running the testcase.
+  class RunObserver {
+  public:
+    virtual void phase_start(Testcase&, Phase) {}
+    virtual void phase_done(Testcase&, Phase) {}
+    // around writing an artifact, p.e. a buffer dump, on the writing thread
+    virtual void artifact_start(const std::string&) {}
+    virtual void artifact_done(const std::string&) {}
+    virtual ~RunObserver() {}
+  };
+
+  // notifies the observers about writing an artifact while it exists
+  class ArtifactObservation {
+  private:
+    std::string name;
+  public:
+    explicit ArtifactObservation(const std::string& _name);
+    ~ArtifactObservation();
+  };
+
+  // ================================================================
+
+  // Runner
+  // ------
+
+  // only declared here, defined by adaptest/runner.h
+
+  struct RunOptions;
+  class Testcases;
+  class RepeatStats;
+
+
   // ================================================================   
     
 
@@ -194,15 +492,39 @@ namespace ADAPTEST_NAMESPACE {
   class Testcase {
   private:
     TestsuiteBase* testsuite;
+    CheckLog* checklog;
   public:
+    Testcase() : testsuite(0), checklog(0) {}
     virtual std::string& getName() = 0;
     virtual std::string& getDesc() = 0;
     virtual Result run() = 0;
+    // a fresh instance of the same testcase, 0 if the testcase can't be cloned
+    virtual Testcase* newInstance() { return 0; }
+    // parameterized testcases are run once per row, each row is a fresh
+    // instance named "name[row]". 0 rows run the testcase itself.
+    virtual size_t getRows() { return 0; }
+    virtual Testcase* newRow(size_t) { return 0; }
     virtual void setUp() {}
     virtual void tearDown() {}
     virtual ~Testcase() {}
     void setTestsuite(TestsuiteBase& _testsuite) { testsuite = &_testsuite;}
     TestsuiteBase& getTestsuite() { return *testsuite; }
+    void setCheckLog(CheckLog& _checklog) { checklog = &_checklog; }
+
+    // store the result of a CHECK() without aborting the testcase
+    void record_check(const Result& res) {
+      if (checklog) checklog->add(res);
+    }
+
+    // count passed CHECK()s which were not recorded one by one
+    void record_passed(size_t count) {
+      if (checklog) checklog->add_passed(count);
+    }
+
+    // store a message which is passed to Logger::test_info()
+    void record_info(const std::string& msg, const int line) {
+      if (checklog) checklog->note(Result(OK, "", line, msg));
+    }
 
 
     // Test Functions
@@ -269,11 +591,6 @@ namespace ADAPTEST_NAMESPACE {
   
   // ================================================================
 
-  // the testcase registration list
-  typedef std::map<int, Testcase*> Testcases; 
-
-  // ================================================================
-
   // Test Suite
   // ----------
 
@@ -281,6 +598,7 @@ namespace ADAPTEST_NAMESPACE {
   protected:
     std::string name;
     std::string description;
+    CheckLog checks;
   public:
     TestsuiteBase(const char * myname, const char * mydesc)
     : name(myname)
@@ -289,41 +607,64 @@ namespace ADAPTEST_NAMESPACE {
 
     std::string& getName()          { return name; }
 
-    // Run Testsuite
-    void run_tests(Testcases& tests, Logger& logger) {
-      logger.testsuite_start(*this);
+    // notify the RunObservers
+    static void phase_start(Testcase& test, Phase phase);
+    static void phase_done(Testcase& test, Phase phase);
 
-      for (Testcases::iterator i = tests.begin(); i != tests.end(); ++i)
-      {
-        Testcase* test = i->second;
+    // run a single instance of a testcase, the failed CHECK()s and the notes
+    // are left in checks
+    Result run_testcase(Testcase& test, CheckLog& checks);
 
-        logger.test_start(*test);
+    static void log_result(Logger& logger, Testcase& test, Result& retval);
 
-        // run testcase
-        test->setTestsuite(*this);
-        test->setUp();
-        Result retval = test->run();
-        test->tearDown();
+    // log the notes, the failed CHECK()s and the result of a finished test
+    static void log_checks(
+      Logger& logger, Testcase& test, CheckLog& checks, Result& retval);
 
-        if (retval.resval == FAILED) {
-          logger.test_failed(*test, retval);
-        } else if (retval.resval == ERROR) {
-          logger.test_error(*test, retval);
-        } else {
-          logger.test_passed(*test);
-        }
+    // run fresh instances of test until the repetition count is reached or,
+    // with until_fail, a repetition failed. stop may be shared by threads.
+    void repeat_testcase(
+      Testcase& test, const RunOptions& options, RepeatStats& stats,
+      size_t& next, bool& stop);
 
-        delete test;
-      }
+    void run_repeated(Testcase& test, Logger& logger, const RunOptions& options);
 
-      logger.testsuite_done(*this);
-    }
+    // one row of a parameterized testcase, run by any thread and logged in
+    // order afterwards
+    struct RowRun {
+      Testcase* row;
+      Result result;
+      CheckLog checks;
+      RowRun() : row(0), result(OK) {}
+    };
+
+    // run the rows first .. first + count - 1 of test into runs
+    void run_row_batch(
+      Testcase& test, const RunOptions& options, RowRun* runs,
+      size_t first, size_t count, size_t& next);
+
+    // run every row of a parameterized testcase as a testcase of its own.
+    // rows are run in batches on options.jobs threads.
+    void run_rows(Testcase& test, Logger& logger, const RunOptions& options);
 
-    virtual void run(Logger& logger) = 0;
+    // Run Testsuite
+    void run_tests(
+      Testcases& tests, Logger& logger, const RunOptions& options);
+
+    virtual void run(Logger& logger, const RunOptions& options) = 0;
   };
 
   //--------------------------------------------------------------------------
 
+  // the testcases of a testsuite, created upon the first registration
+  ADAPTEST_RUNNER_INLINE
+  Testcases& testcase_list(Testcases*& storage);
+
+  ADAPTEST_RUNNER_INLINE
+  void add_testcase(Testcases& tests, Testcase* testcase, const int line);
+
+  //--------------------------------------------------------------------------
+
   template<class TestcaseClass, Testcases*& testcaseStorage>
   class Testsuite : public TestsuiteBase {
   public:
@@ -335,12 +676,11 @@ namespace ADAPTEST_NAMESPACE {
     {}
 
     static Testcases& getTests() {
-      if (!testcaseStorage) testcaseStorage = new Testcases();
-      return *testcaseStorage;
+      return testcase_list(testcaseStorage);
     }
 
     static void addTestcase( Testcase* testcase, const int line ) {
-      getTests()[line] = testcase;
+      add_testcase(getTests(), testcase, line);
     } 
 
     template <class CurrentTestcase, int Line>
@@ -352,8 +692,8 @@ namespace ADAPTEST_NAMESPACE {
       }
     };
 
-    virtual void run(Logger& logger) {
-      run_tests(getTests(), logger);
+    virtual void run(Logger& logger, const RunOptions& options) {
+      run_tests(getTests(), logger, options);
     }
   };
 
@@ -362,144 +702,18 @@ namespace ADAPTEST_NAMESPACE {
   // Testsuite Auto registration
   // ---------------------------
 
-  typedef std::list<TestsuiteBase*> Testsuites;
-  Logger* logger;
-
-  class TestsuiteRegistration {
-  public:
-    static Testsuites* storage;
-
-    // constructor which in fact registers the testsuite
-    static void add(TestsuiteBase* testsuite) {
-      if (!storage) storage = new Testsuites();
-      storage->push_back(testsuite);
-    }
-
-    static int run(Logger& logger) {
-      if (!storage) return -1;
-
-      for (Testsuites::iterator i = storage->begin(); 
-           i != storage->end(); ++i)
-      {
-        (*i)->run(logger);  
-      }
-
-      return logger.getFailed();
-    }
-  };
+  ADAPTEST_RUNNER_INLINE
+  void register_testsuite(TestsuiteBase* testsuite);
 
   template <class CurrentTestsuite>
   class RegisterTestsuite {
   public:
     // constructor which in fact registers the testsuite
     RegisterTestsuite() {
-      TestsuiteRegistration::add(new CurrentTestsuite());
+      register_testsuite(new CurrentTestsuite());
     }
   };
 
-  // ======================================================================== 
-
-  // Logging unto the Console
-  // ------------------------
-  
-  #if ADAPTEST_DEFAULT_LOGGER
-
-    class ConsoleLogger : public Logger {
-    private:
-        int num_tests;
-        int passed_tests;
-        int failed_tests;
-
-    public:
-
-      ConsoleLogger()
-        : num_tests(0)
-        , passed_tests(0)
-        , failed_tests(0)
-      {}
-
-      virtual ~ConsoleLogger() {
-        std::cout << num_tests
-          << " tests done: " 
-          << " passed: " << passed_tests 
-          << " failed: " << failed_tests
-          << std::endl;     
-      }
-
-      virtual void test_passed(Testcase& test)
-      {
-        passed_tests++;
-        num_tests++;
-      }
-
-      virtual void test_failed(Testcase& testcase, Result& res)
-      {
-        std::cout 
-          << std::right
-          #if ADAPTEST_AUTONAMES
-          << std::setw(40)
-          << testcase.getDesc()
-          #else
-          << std::setw(20)
-          << testcase.getName()
-          #endif
-          << " : "
-          << res.line
-          << " : "
-          << std::left
-          << std::setw(40)
-          << res.msg
-          << std::endl;
-        failed_tests++;
-        num_tests++;
-      }
-
-      virtual void testsuite_start(TestsuiteBase& suite)
-      {
-        std::cout << "processing testsuite " << suite.getName() << std::endl;
-      }
-
-      virtual void testsuite_done(TestsuiteBase& suite)   
-      {}
-
-      virtual void test_start(Testcase& testcase)
-      {}
-
-      virtual int getFailed()
-      { return failed_tests; }
-
-      virtual void test_error(Testcase& test, Result& res)
-      {
-        std::cout 
-          << "ERROR : "
-          << std::right
-          #if ADAPTEST_AUTONAMES
-          << test.getDesc()
-          #else
-          << test.getName()
-          #endif
-          << " : "
-          << res.line
-          << " : "
-          << std::left
-          << std::setw(40)
-          << res.msg
-          << std::endl;
-        failed_tests++;
-        num_tests++;
-      }
-    };  
-
-  #endif //ADAPTEST_DEFAULT_LOGGER
-
-  // Main entrance Functions
-  // -----------------------
-
-  inline
-  int run(Logger& logger) {
-    return TestsuiteRegistration::run(logger);
-  }
-
 } // namespace ADAPTEST_NAMESPACE
 
 
@@ -557,6 +771,7 @@ namespace ADAPTEST_NAMESPACE {
     _name() : name(#_name), desc(_desc) {}                                     \
     virtual std::string& getName() { return name; }                            \
     virtual std::string& getDesc() { return desc; }                            \
+    virtual ADAPTEST_NAMESPACE::Testcase* newInstance() { return new _name(); }\
     virtual ADAPTEST_NAMESPACE::Result run() {                                 \
 
 #define END_TESTCASE()                                                         \
@@ -574,23 +789,46 @@ namespace ADAPTEST_NAMESPACE {
   if (retval.resval != ADAPTEST_NAMESPACE::OK) return retval;                  \
 }
 
+// call a test function and continue upon failure. all failures are logged
+// and merged into the result of the testcase after it has been run.
+#define CHECK(testtype, ...)  {                                                \
+  record_check(test_##testtype(__VA_ARGS__, __LINE__));                        \
+}
+
 // Adapted Global Variables
 // ------------------------
 
-#define ADAPTEST_GLOBALS()                                                     \
-  ADAPTEST_NAMESPACE::Testsuites*                                              \
-    ADAPTEST_NAMESPACE::TestsuiteRegistration::storage = 0;                    \
+// all globals live in the header now. kept for compatibility.
+#define ADAPTEST_GLOBALS()
 
 
 // Run Autoregistered Testsuites
 // -----------------------------
 
+// must be used in exactly one translation unit of an executable, all others
+// just define their testsuites.
 #define ADAPTEST_MAIN(LoggerClass)                                             \
-  ADAPTEST_GLOBALS()                                                           \
   int main(int argc, char const *argv[])                                       \
   {                                                                            \
+    ADAPTEST_NAMESPACE::RunOptions options;                                    \
+    if (!ADAPTEST_NAMESPACE::parse_options(argc, argv, options)) {             \
+      ADAPTEST_NAMESPACE::print_usage(argv[0]);                                \
+      return 2;                                                                \
+    }                                                                          \
+    if (options.list) {                                                        \
+      return ADAPTEST_NAMESPACE::TestsuiteRegistration::list();                \
+    }                                                                          \
+    if (!options.serve.empty()) {                                              \
+      return ADAPTEST_NAMESPACE::TestsuiteRegistration::serve(options);        \
+    }                                                                          \
     ADAPTEST_NAMESPACE::LoggerClass logger;                                    \
-    return ADAPTEST_NAMESPACE::run(logger);                                    \
+    return ADAPTEST_NAMESPACE::run(logger, options);                           \
   }                                                                            \
 
+// the runner, which is only declared to the testsuites in build throughput
+// mode
+#if ADAPTEST_RUNNER_DEFINITIONS
+#include <adaptest/runner.h>
+#endif
+
 #endif //ADAPTEST_H
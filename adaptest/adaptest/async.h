@@ -0,0 +1,627 @@
+#ifndef ADAPTEST_ASYNC_H
+#define ADAPTEST_ASYNC_H
+
+#include <adaptest.h>
+#include <adaptest/runner.h>
+
+// asynchronous testcases for Adaptest. the body of a TESTCASE_ASYNC() is a
+// coroutine which may co_await sleep_for(), readable(), writable() and ready()
+// of a std::future. the testcases of a TESTSUITE_ASYNC() are all started at
+// once and run concurrently on a single threaded event loop (epoll on Linux,
+// poll() elsewhere). within a TESTSUITE() they are run one after another.
+// use CO_TEST() instead of TEST() inside of the coroutines, CHECK() works as
+// usual. requires C++20.
+//
+//   TESTSUITE_ASYNC(MySuite, AdapTest::AsyncTestcase, "")
+//     TESTCASE_ASYNC(waits, "")
+//       co_await AdapTest::sleep_for(std::chrono::milliseconds(10));
+//       CO_TEST(eq, 1, 1, "one")
+//     END_TESTCASE_ASYNC()
+//   END_TESTSUITE()
+
+// interval in which a co_awaited std::future is polled
+#ifndef ADAPTEST_ASYNC_FUTURE_POLL_MS
+#define ADAPTEST_ASYNC_FUTURE_POLL_MS 1
+#endif // !ADAPTEST_ASYNC_FUTURE_POLL_MS
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include <cerrno>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Event Loop
+  // ----------
+
+  // a suspended coroutine waiting for a timer or a file descriptor. whichever
+  // comes first resumes it, the other one finds the waiter done.
+  struct AsyncWaiter {
+    std::coroutine_handle<> handle;
+    int fd;
+    bool write;
+    bool done;
+    bool timedout;
+
+    AsyncWaiter(std::coroutine_handle<> _handle, int _fd, bool _write = false)
+    : handle(_handle)
+    , fd(_fd)
+    , write(_write)
+    , done(false)
+    , timedout(false)
+    {}
+  };
+
+  typedef std::shared_ptr<AsyncWaiter> AsyncWaiterPtr;
+
+  //--------------------------------------------------------------------------
+
+  class EventLoop {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+  private:
+    struct Timer {
+      Clock::time_point deadline;
+      AsyncWaiterPtr waiter;
+      bool operator < (const Timer& o) const { return deadline > o.deadline; }
+    };
+
+    std::priority_queue<Timer> timers;
+    std::vector<AsyncWaiterPtr> io;
+    size_t pending;
+    #ifdef __linux__
+    int epollfd;
+    #endif
+
+    static EventLoop*& currentLoop() {
+      static thread_local EventLoop* loop = 0;
+      return loop;
+    }
+
+    EventLoop* previous;
+
+    EventLoop(const EventLoop&);
+    EventLoop& operator = (const EventLoop&);
+
+    void resume(const AsyncWaiterPtr& waiter, bool timedout) {
+      if (waiter->done) return;
+      waiter->done = true;
+      waiter->timedout = timedout;
+      pending--;
+      if (waiter->fd >= 0) unwatch(*waiter);
+      waiter->handle.resume();
+    }
+
+    void unwatch(AsyncWaiter& waiter) {
+      for (size_t i = 0; i < io.size(); ++i) {
+        if (io[i].get() == &waiter) {
+          io.erase(io.begin() + i);
+          break;
+        }
+      }
+      #ifdef __linux__
+      epoll_ctl(epollfd, EPOLL_CTL_DEL, waiter.fd, 0);
+      #endif
+    }
+
+  public:
+    EventLoop()
+    : pending(0)
+    , previous(currentLoop())
+    {
+      #ifdef __linux__
+      epollfd = epoll_create1(EPOLL_CLOEXEC);
+      #endif
+      currentLoop() = this;
+    }
+
+    ~EventLoop() {
+      #ifdef __linux__
+      close(epollfd);
+      #endif
+      currentLoop() = previous;
+    }
+
+    // the innermost loop of this thread
+    static EventLoop& current() {
+      return *currentLoop();
+    }
+
+    static bool exists() {
+      return currentLoop() != 0;
+    }
+
+    void add_timer(const AsyncWaiterPtr& waiter, Clock::time_point deadline) {
+      Timer timer = { deadline, waiter };
+      timers.push(timer);
+      if (waiter->fd < 0) pending++;
+    }
+
+    // one waiter per file descriptor at a time
+    bool add_io(const AsyncWaiterPtr& waiter) {
+      #ifdef __linux__
+      epoll_event ev;
+      ev.events = (waiter->write ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+      ev.data.ptr = waiter.get();
+      if (epoll_ctl(epollfd, EPOLL_CTL_ADD, waiter->fd, &ev) != 0
+          && (errno != EEXIST
+              || epoll_ctl(epollfd, EPOLL_CTL_MOD, waiter->fd, &ev) != 0)) {
+        return false;
+      }
+      #endif
+      io.push_back(waiter);
+      pending++;
+      return true;
+    }
+
+    // run until there is nothing left to wait for
+    void run() {
+      while (pending) {
+        // fire expired timers
+        const Clock::time_point now = Clock::now();
+        while (!timers.empty() && timers.top().deadline <= now) {
+          AsyncWaiterPtr waiter = timers.top().waiter;
+          timers.pop();
+          resume(waiter, true);
+        }
+        if (!pending) break;
+
+        int timeout = -1;
+        if (!timers.empty()) {
+          const Clock::duration wait = timers.top().deadline - Clock::now();
+          timeout = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()
+            + 1);
+          if (timeout < 0) timeout = 0;
+        }
+        if (io.empty()) {
+          if (timeout > 0) {
+            usleep(static_cast<useconds_t>(timeout) * 1000);
+          }
+          continue;
+        }
+
+        poll_io(timeout);
+      }
+    }
+
+  private:
+    void poll_io(int timeout) {
+      #ifdef __linux__
+        epoll_event events[64];
+        const int n = epoll_wait(epollfd, events, 64, timeout);
+        std::vector<AsyncWaiterPtr> fired;
+        for (int i = 0; i < n; ++i) {
+          for (size_t w = 0; w < io.size(); ++w) {
+            if (io[w].get() == events[i].data.ptr) fired.push_back(io[w]);
+          }
+        }
+      #else
+        std::vector<pollfd> fds(io.size());
+        for (size_t w = 0; w < io.size(); ++w) {
+          fds[w].fd = io[w]->fd;
+          fds[w].events = io[w]->write ? POLLOUT : POLLIN;
+          fds[w].revents = 0;
+        }
+        const int n = ::poll(&fds[0], fds.size(), timeout);
+        std::vector<AsyncWaiterPtr> fired;
+        for (size_t w = 0; n > 0 && w < fds.size(); ++w) {
+          if (fds[w].revents) fired.push_back(io[w]);
+        }
+      #endif
+      for (size_t i = 0; i < fired.size(); ++i) resume(fired[i], false);
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // co_await sleep_for(duration)
+  class SleepAwaiter {
+  private:
+    EventLoop::Clock::time_point deadline;
+
+  public:
+    explicit SleepAwaiter(EventLoop::Clock::time_point _deadline)
+    : deadline(_deadline)
+    {}
+
+    bool await_ready() const { return deadline <= EventLoop::Clock::now(); }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      EventLoop::current().add_timer(
+        std::make_shared<AsyncWaiter>(handle, -1), deadline);
+    }
+
+    void await_resume() const {}
+  };
+
+  template <class Rep, class Period>
+  SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+    return SleepAwaiter(EventLoop::Clock::now()
+      + std::chrono::duration_cast<EventLoop::Clock::duration>(duration));
+  }
+
+  //--------------------------------------------------------------------------
+
+  // co_await readable(fd) or writable(fd). with a timeout in milliseconds the
+  // result is false if the timeout passed first.
+  class IoAwaiter {
+  private:
+    int fd;
+    bool write;
+    int timeout;
+    AsyncWaiterPtr waiter;
+
+  public:
+    IoAwaiter(int _fd, bool _write, int _timeout)
+    : fd(_fd)
+    , write(_write)
+    , timeout(_timeout)
+    {}
+
+    bool await_ready() const { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      EventLoop& loop = EventLoop::current();
+      waiter = std::make_shared<AsyncWaiter>(handle, fd, write);
+      if (!loop.add_io(waiter)) {
+        waiter->timedout = true;
+        return false;  // invalid fd, don't wait
+      }
+      if (timeout >= 0) {
+        loop.add_timer(waiter, EventLoop::Clock::now()
+          + std::chrono::milliseconds(timeout));
+      }
+      return true;
+    }
+
+    bool await_resume() const { return !waiter->timedout; }
+  };
+
+  inline IoAwaiter readable(int fd, int timeout_ms = -1) {
+    return IoAwaiter(fd, false, timeout_ms);
+  }
+
+  inline IoAwaiter writable(int fd, int timeout_ms = -1) {
+    return IoAwaiter(fd, true, timeout_ms);
+  }
+
+  //--------------------------------------------------------------------------
+
+  // co_await ready(future) returns future.get() once the future is ready
+  template <class T>
+  class FutureAwaiter {
+  private:
+    std::future<T>& future;
+
+    bool is_ready() const {
+      return future.wait_for(std::chrono::seconds(0))
+             == std::future_status::ready;
+    }
+
+  public:
+    explicit FutureAwaiter(std::future<T>& _future) : future(_future) {}
+
+    bool await_ready() const { return is_ready(); }
+
+    // a std::future can't notify anyone, so a helper coroutine polls it
+    void await_suspend(std::coroutine_handle<> handle) {
+      poll_loop(future, handle).handle.resume();
+    }
+
+    T await_resume() { return future.get(); }
+
+  private:
+    // destroys itself when done
+    struct PollTask {
+      struct promise_type {
+        PollTask get_return_object() {
+          return PollTask(
+            std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+      };
+      std::coroutine_handle<promise_type> handle;
+      explicit PollTask(std::coroutine_handle<promise_type> _handle)
+      : handle(_handle)
+      {}
+    };
+
+    // resumes handle once the future is ready
+    static PollTask poll_loop(std::future<T>& future,
+                              std::coroutine_handle<> handle)
+    {
+      while (future.wait_for(std::chrono::seconds(0))
+             != std::future_status::ready) {
+        co_await sleep_for(
+          std::chrono::milliseconds(ADAPTEST_ASYNC_FUTURE_POLL_MS));
+      }
+      handle.resume();
+    }
+  };
+
+  template <class T>
+  FutureAwaiter<T> ready(std::future<T>& future) {
+    return FutureAwaiter<T>(future);
+  }
+
+  // ================================================================
+
+  // Coroutine Task
+  // --------------
+
+  // the return type of asynchronous testcase bodies and helper coroutines.
+  // co_return a Result, co_await another AsyncResult to get its Result.
+  class AsyncResult {
+  public:
+    struct promise_type {
+      Result result;
+      std::coroutine_handle<> continuation;
+
+      promise_type() : result(OK) {}
+
+      AsyncResult get_return_object() {
+        return AsyncResult(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+
+      std::suspend_always initial_suspend() noexcept { return {}; }
+
+      // resume whoever co_awaited this task
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> handle) noexcept
+        {
+          std::coroutine_handle<> next = handle.promise().continuation;
+          return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+
+      FinalAwaiter final_suspend() noexcept { return FinalAwaiter(); }
+
+      void return_value(const Result& res) { result = res; }
+
+      void unhandled_exception() {
+        try {
+          throw;
+        } catch (std::exception& e) {
+          result = Result(ERROR, "", 0, format("exception: {}", e.what()));
+        } catch (...) {
+          result = Result(ERROR, "", 0, "unknown exception");
+        }
+      }
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+  private:
+    Handle handle;
+
+  public:
+    explicit AsyncResult(Handle _handle) : handle(_handle) {}
+
+    AsyncResult(AsyncResult&& o) : handle(o.handle) { o.handle = Handle(); }
+
+    AsyncResult& operator = (AsyncResult&& o) {
+      if (handle) handle.destroy();
+      handle = o.handle;
+      o.handle = Handle();
+      return *this;
+    }
+
+    ~AsyncResult() { if (handle) handle.destroy(); }
+
+    // run until the first suspension
+    void start() { handle.resume(); }
+    bool done() const { return handle.done(); }
+    Result result() const { return handle.promise().result; }
+
+    // awaiting another task
+    bool await_ready() const { return handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) {
+      handle.promise().continuation = caller;
+      return handle;
+    }
+    Result await_resume() const { return result(); }
+  };
+
+  // ================================================================
+
+  // Asynchronous Testcase
+  // ---------------------
+
+  class AsyncTestcase : public virtual Testcase {
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    // the body of TESTCASE_ASYNC()
+    virtual AsyncResult run_async() = 0;
+
+    // run the coroutine to completion on the current or an own event loop
+    virtual Result run() {
+      if (!EventLoop::exists()) {
+        EventLoop loop;
+        return run_on(loop);
+      }
+      return run_on(EventLoop::current());
+    }
+
+  private:
+    Result run_on(EventLoop& loop) {
+      AsyncResult task = run_async();
+      task.start();
+      loop.run();
+      if (!task.done()) {
+        return Result(ERROR, "", 0, "coroutine suspended without event");
+      }
+      return task.result();
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // a Testsuite which starts all of its asynchronous testcases at once and
+  // runs them concurrently on one event loop
+  template<class TestcaseClass, Testcases*& testcaseStorage>
+  class AsyncTestsuite : public Testsuite<TestcaseClass, testcaseStorage> {
+  public:
+    typedef Testsuite<TestcaseClass, testcaseStorage> Base;
+
+    AsyncTestsuite(const char * myname, const char * mydesc)
+    : Base(myname, mydesc)
+    {}
+
+    virtual void run(Logger& logger, const RunOptions& options) {
+      if (options.repeating()) {
+        Base::run(logger, options);
+        return;
+      }
+
+      struct Running {
+        Testcase* test;
+        Testcase* instance;
+        CheckLog checks;
+        std::unique_ptr<AsyncResult> task;
+        Result result;
+        Running() : test(0), instance(0), result(OK) {}
+      };
+
+      logger.testsuite_start(*this);
+
+      EventLoop loop;
+      std::vector<std::unique_ptr<Running> > running;
+      Testcases& tests = Base::getTests();
+      for (Testcases::iterator i = tests.begin(); i != tests.end(); ++i)
+      {
+        if (!options.testcase_selected(i->second->getName())
+            && !options.rows_selected(i->second->getName())) continue;
+
+        // parameterized testcases are run and logged right away
+        if (i->second->getRows()) {
+          this->run_rows(*i->second, logger, options);
+          continue;
+        }
+        if (!options.testcase_selected(i->second->getName())) continue;
+
+        std::unique_ptr<Running> r(new Running());
+        r->test = i->second;
+        r->instance = r->test->newInstance();
+        Testcase& instance = r->instance ? *r->instance : *r->test;
+        AsyncTestcase* async = dynamic_cast<AsyncTestcase*>(&instance);
+
+        if (!async) {
+          // synchronous testcases run right away
+          r->result = this->run_testcase(instance, r->checks);
+        } else {
+          instance.setTestsuite(*this);
+          instance.setCheckLog(r->checks);
+          // the run phases interleave, only setUp and tearDown are observed
+          this->phase_start(instance, SETUP);
+          instance.setUp();
+          this->phase_done(instance, SETUP);
+          r->task.reset(new AsyncResult(async->run_async()));
+          r->task->start();
+        }
+        running.push_back(std::move(r));
+      }
+
+      loop.run();
+
+      for (size_t i = 0; i < running.size(); ++i) {
+        Running& r = *running[i];
+        Testcase& instance = r.instance ? *r.instance : *r.test;
+
+        if (r.task) {
+          r.result = r.task->done() ? r.task->result()
+            : Result(ERROR, "", 0, "coroutine suspended without event");
+          r.task.reset();
+          this->phase_start(instance, TEARDOWN);
+          instance.tearDown();
+          this->phase_done(instance, TEARDOWN);
+          r.result = r.checks.aggregate(r.result);
+        }
+
+        logger.test_start(*r.test);
+        this->log_checks(logger, *r.test, r.checks, r.result);
+        delete r.instance;
+      }
+
+      logger.testsuite_done(*this);
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+// Define an asynchronous Testsuite
+// --------------------------------
+
+#define TESTSUITE_ASYNC(_name, _testcase, _desc)                               \
+  class _name;                                                                 \
+  ADAPTEST_NAMESPACE::RegisterTestsuite<_name> _name##Reg;                     \
+  ADAPTEST_NAMESPACE::Testcases* _name##List = 0;                              \
+  typedef ADAPTEST_NAMESPACE::AsyncTestsuite<_testcase,_name##List>            \
+    _name##Base;                                                               \
+  class _name : public _name##Base                                             \
+  {                                                                            \
+  public:                                                                      \
+    _name()                                                                    \
+    : _name##Base(#_name, _desc)                                               \
+    {}                                                                         \
+  private:                                                                     \
+
+// Define an asynchronous Testcase
+// -------------------------------
+
+#if ADAPTEST_AUTONAMES == 1
+#define TESTCASE_ASYNC(_desc)                                                  \
+  TESTCASE_ASYNC__( TONICTEST_NAME( testcase_ ), _desc )
+#define TESTCASE_ASYNC__(_name, _desc) TESTCASE_ASYNC_(_name, _desc)
+#else
+#define TESTCASE_ASYNC(_name, _desc) TESTCASE_ASYNC_(_name, _desc)
+#endif
+
+#define TESTCASE_ASYNC_(_name, _desc)                                          \
+  class _name;                                                                 \
+  TestcaseRegistration<_name, __LINE__> _name##Reg;                            \
+  class _name : public LocalTestcase {                                         \
+    std::string name;                                                          \
+    std::string desc;                                                          \
+    public:                                                                    \
+    _name() : name(#_name), desc(_desc) {}                                     \
+    virtual std::string& getName() { return name; }                            \
+    virtual std::string& getDesc() { return desc; }                            \
+    virtual ADAPTEST_NAMESPACE::Testcase* newInstance() { return new _name(); }\
+    virtual ADAPTEST_NAMESPACE::AsyncResult run_async() {                      \
+
+#define END_TESTCASE_ASYNC()                                                   \
+      co_return ADAPTEST_NAMESPACE::OK;                                        \
+    }                                                                          \
+  };                                                                           \
+
+// call a test function inside of a coroutine and return upon failure
+#define CO_TEST(testtype, ...)  {                                              \
+  const ADAPTEST_NAMESPACE::Result retval =                                    \
+    test_##testtype(__VA_ARGS__, __LINE__);                                    \
+  if (retval.resval != ADAPTEST_NAMESPACE::OK) co_return retval;               \
+}
+
+#endif //ADAPTEST_ASYNC_H
@@ -0,0 +1,188 @@
+#ifndef ADAPTEST_ASYNCWRITE_H
+#define ADAPTEST_ASYNCWRITE_H
+
+#include <adaptest.h>
+#include <adaptest/runner.h>
+#include <adaptest/buf.h>
+
+// a WriterPolicy adapter for BufferTestcase which copies the buffers of a
+// failed test and writes them on a background thread, so the testcase returns
+// without waiting for the file I/O. all pending writes are flushed after the
+// last testsuite, errors are passed to Logger::artifact_error() then.
+// requires C++11 and ADAPTEST_BUFWRITE_FILE.
+//
+//   class MyTestcase
+//     : public AdapTest::BufferTestcase<AdapTest::AsyncCSVBufferWriter> {};
+
+// maximal number of queued writes. a failing test blocks while the queue is
+// full. the background thread takes the whole queue at once, so up to twice
+// as many buffer copies may exist.
+#ifndef ADAPTEST_ASYNCWRITE_QUEUE
+#define ADAPTEST_ASYNCWRITE_QUEUE 64
+#endif // !ADAPTEST_ASYNCWRITE_QUEUE
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+#if ADAPTEST_BUFWRITE_FILE
+
+  // one queued write
+  class ArtifactJob {
+  public:
+    virtual Result write() = 0;
+    virtual ~ArtifactJob() {}
+  };
+
+  //--------------------------------------------------------------------------
+
+  // the bounded queue and its background thread. there is one per process,
+  // it's destructor flushes the queue upon exit.
+  class ArtifactQueue : public RunFinalizer {
+  private:
+    typedef std::list<Result> Results;
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable done;
+    std::deque<ArtifactJob*> jobs;
+    Results errors;
+    bool busy;
+    bool stopping;
+    std::thread worker;
+
+    void work() {
+      std::unique_lock<std::mutex> lock(mutex);
+      for (;;) {
+        queued.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return;
+
+        // write everything queued so far as one batch
+        std::deque<ArtifactJob*> batch;
+        batch.swap(jobs);
+        busy = true;
+        done.notify_all();
+        lock.unlock();
+
+        Results failed;
+        for (size_t i = 0; i < batch.size(); ++i) {
+          Result res = batch[i]->write();
+          if (res.resval != OK) failed.push_back(res);
+          delete batch[i];
+        }
+
+        lock.lock();
+        errors.splice(errors.end(), failed);
+        busy = false;
+        done.notify_all();
+      }
+    }
+
+    ArtifactQueue()
+    : busy(false)
+    , stopping(false)
+    {
+      worker = std::thread(&ArtifactQueue::work, this);
+      TestsuiteRegistration::addFinalizer(this);
+    }
+
+  public:
+    static ArtifactQueue& instance() {
+      static ArtifactQueue queue;
+      return queue;
+    }
+
+    ~ArtifactQueue() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      queued.notify_all();
+      worker.join();
+    }
+
+    // takes ownership of job, blocks while the queue is full
+    void push(ArtifactJob* job) {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [this]() {
+        return jobs.size() < ADAPTEST_ASYNCWRITE_QUEUE;
+      });
+      jobs.push_back(job);
+      queued.notify_one();
+    }
+
+    // wait until everything queued is written. returns the failed writes.
+    Results flush() {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [this]() { return jobs.empty() && !busy; });
+      Results failed;
+      failed.swap(errors);
+      return failed;
+    }
+
+    virtual void finish(Logger& logger) {
+      Results failed = flush();
+      for (Results::iterator i = failed.begin(); i != failed.end(); ++i) {
+        logger.artifact_error(*i);
+      }
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  template <template <class> class WriterPolicy>
+  class AsyncWriter {
+  private:
+    // the wrapped writer together with the copies of its buffers
+    template <class T>
+    class Job : public ArtifactJob {
+    public:
+      WriterPolicy<T> writer;
+      std::list<std::vector<T> > copies;
+
+      Job(const int line, Testcase& testcase)
+      : writer(line, testcase)
+      {}
+
+      virtual Result write() { return writer.write(); }
+    };
+
+  public:
+    template <class T>
+    class Policy {
+    private:
+      std::unique_ptr<Job<T> > job;
+
+    public:
+      Policy(const int line, Testcase& testcase)
+      : job(new Job<T>(line, testcase))
+      {}
+
+      void add_buf(const T* buf, const size_t buflen, std::string name)
+      {
+        job->copies.push_back(std::vector<T>(buf, buf + buflen));
+        job->writer.add_buf(job->copies.back().data(), buflen, name);
+      }
+
+      // queue the write, errors are reported after the run
+      Result write() {
+        ArtifactQueue::instance().push(job.release());
+        return OK;
+      }
+    };
+  };
+
+  template <class T>
+  using AsyncCSVBufferWriter = AsyncWriter<CSVBufferWriter>::Policy<T>;
+
+#endif // ADAPTEST_BUFWRITE_FILE
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_ASYNCWRITE_H
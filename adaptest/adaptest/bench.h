@@ -0,0 +1,635 @@
+#ifndef ADAPTEST_BENCH_H
+#define ADAPTEST_BENCH_H
+
+#include <adaptest.h>
+#include <adaptest/dygraph.h>
+
+// a Testcase Base Class for Adaptest which measures the runtime of a callable
+// and compares it against the samples of a previous run (the baseline). a
+// slowdown fails the test if the Mann-Whitney U test rejects that both runs
+// have the same distribution and the median shift exceeds a threshold.
+// the benchmark thread may be pinned to a cpu and run with a raised priority.
+// the cpu frequency governor, turbo and the load of the SMT siblings are
+// recorded (Linux only) and the coefficient of variation of the samples is
+// reported, noisy results are flagged as unreliable. several benchmarks added
+// by add_bench() are sampled interleaved by test_benches(), so drift hits all
+// of them alike. requires C++11.
+
+// number of samples taken per benchmark
+#ifndef ADAPTEST_BENCH_SAMPLES
+#define ADAPTEST_BENCH_SAMPLES 30
+#endif // !ADAPTEST_BENCH_SAMPLES
+
+// significance level of the one sided Mann-Whitney U test
+#ifndef ADAPTEST_BENCH_ALPHA
+#define ADAPTEST_BENCH_ALPHA 0.01
+#endif // !ADAPTEST_BENCH_ALPHA
+
+// minimal relative slowdown (Hodges-Lehmann shift / baseline median) which
+// is reported, smaller significant changes are accepted
+#ifndef ADAPTEST_BENCH_THRESHOLD
+#define ADAPTEST_BENCH_THRESHOLD 0.05
+#endif // !ADAPTEST_BENCH_THRESHOLD
+
+// if this environment variable is set, the baselines are overwritten
+#ifndef ADAPTEST_BENCH_UPDATE_ENV
+#define ADAPTEST_BENCH_UPDATE_ENV "ADAPTEST_UPDATE_BASELINE"
+#endif // !ADAPTEST_BENCH_UPDATE_ENV
+
+// cpu the benchmark thread is pinned to, -1 doesn't pin
+#ifndef ADAPTEST_BENCH_CPU
+#define ADAPTEST_BENCH_CPU -1
+#endif // !ADAPTEST_BENCH_CPU
+
+// nice value of the benchmark thread if bench_priority is set
+#ifndef ADAPTEST_BENCH_NICE
+#define ADAPTEST_BENCH_NICE -10
+#endif // !ADAPTEST_BENCH_NICE
+
+// raise the priority of the benchmark thread by default
+#ifndef ADAPTEST_BENCH_PRIORITY
+#define ADAPTEST_BENCH_PRIORITY 0
+#endif // !ADAPTEST_BENCH_PRIORITY
+
+// coefficient of variation above which a result is flagged unreliable
+#ifndef ADAPTEST_BENCH_NOISE
+#define ADAPTEST_BENCH_NOISE 0.05
+#endif // !ADAPTEST_BENCH_NOISE
+
+// load of a SMT sibling of the benchmark cpu which is warned about
+#ifndef ADAPTEST_BENCH_SIBLING_LOAD
+#define ADAPTEST_BENCH_SIBLING_LOAD 0.1
+#endif // !ADAPTEST_BENCH_SIBLING_LOAD
+
+#ifndef ADAPTEST_BENCH_BASELINE_FILENAME_FORMAT
+#define ADAPTEST_BENCH_BASELINE_FILENAME_FORMAT "{}-{}-{}.baseline"
+#endif // !ADAPTEST_BENCH_BASELINE_FILENAME_FORMAT
+
+#ifndef ADAPTEST_BENCH_TREND_FILENAME_FORMAT
+#define ADAPTEST_BENCH_TREND_FILENAME_FORMAT "{}-{}-{}.trend.csv"
+#endif // !ADAPTEST_BENCH_TREND_FILENAME_FORMAT
+
+#ifndef ADAPTEST_BENCH_HTML_FILENAME_FORMAT
+#define ADAPTEST_BENCH_HTML_FILENAME_FORMAT "{}-{}-{}.trend.html"
+#endif // !ADAPTEST_BENCH_HTML_FILENAME_FORMAT
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Statistics
+  // ----------
+
+  typedef std::vector<double> Samples;
+
+  inline double median(Samples samples) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    return n % 2 ? samples[n / 2]
+                 : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+  }
+
+  // one sided Mann-Whitney U test using the normal approximation with tie
+  // correction. returns the p-value for "current is larger than baseline".
+  inline double mann_whitney_p(const Samples& baseline, const Samples& current)
+  {
+    const size_t n1 = current.size(), n2 = baseline.size(), n = n1 + n2;
+    if (!n1 || !n2) return 1;
+
+    // rank the pooled samples, remembering where they came from
+    std::vector<std::pair<double, bool> > pooled;
+    for (size_t i = 0; i < n1; ++i) pooled.push_back(std::make_pair(current[i], true));
+    for (size_t i = 0; i < n2; ++i) pooled.push_back(std::make_pair(baseline[i], false));
+    std::sort(pooled.begin(), pooled.end());
+
+    double ranksum = 0, ties = 0;
+    for (size_t i = 0; i < n; ) {
+      size_t j = i;
+      while (j < n && pooled[j].first == pooled[i].first) ++j;
+      const double rank = (i + j + 1) / 2.0;  // average of ranks i+1..j
+      const double t = j - i;
+      ties += t * t * t - t;
+      for (size_t k = i; k < j; ++k) {
+        if (pooled[k].second) ranksum += rank;
+      }
+      i = j;
+    }
+
+    const double u = ranksum - n1 * (n1 + 1) / 2.0;
+    const double mean = n1 * n2 / 2.0;
+    const double var = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1.0)));
+    if (var <= 0) return 1;
+
+    // continuity correction towards the mean
+    const double z = (u - mean - 0.5) / std::sqrt(var);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+  }
+
+  // standard deviation / mean
+  inline double coefficient_of_variation(const Samples& samples) {
+    if (samples.size() < 2) return 0;
+    double mean = 0, m2 = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const double delta = samples[i] - mean;
+      mean += delta / (i + 1);
+      m2 += delta * (samples[i] - mean);
+    }
+    return mean > 0 ? std::sqrt(m2 / (samples.size() - 1)) / mean : 0;
+  }
+
+  // Hodges-Lehmann estimate of the shift between current and baseline: the
+  // median of all pairwise differences
+  inline double hodges_lehmann(const Samples& baseline, const Samples& current)
+  {
+    Samples diffs;
+    diffs.reserve(baseline.size() * current.size());
+    for (size_t i = 0; i < current.size(); ++i) {
+      for (size_t j = 0; j < baseline.size(); ++j) {
+        diffs.push_back(current[i] - baseline[j]);
+      }
+    }
+    return median(diffs);
+  }
+
+  // ================================================================
+
+  // Run Environment
+  // ---------------
+
+  // pins the calling thread to a cpu and raises its priority while it
+  // exists. failures are collected in warnings.
+  class BenchPinning {
+  private:
+    #ifdef __linux__
+    cpu_set_t previous;
+    bool pinned;
+    int previousNice;
+    bool niced;
+    #endif
+
+  public:
+    std::vector<std::string> warnings;
+
+    BenchPinning(int cpu, bool priority)
+    #ifdef __linux__
+    : pinned(false)
+    , previousNice(0)
+    , niced(false)
+    #endif
+    {
+      #ifdef __linux__
+        if (cpu >= 0) {
+          cpu_set_t set;
+          CPU_ZERO(&set);
+          CPU_SET(cpu, &set);
+          if (sched_getaffinity(0, sizeof(previous), &previous) == 0
+              && sched_setaffinity(0, sizeof(set), &set) == 0) {
+            pinned = true;
+          } else {
+            warnings.push_back(format("could not pin to cpu {}", cpu));
+          }
+        }
+        if (priority) {
+          // the nice value of a thread is set by its thread id
+          const id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+          errno = 0;
+          previousNice = getpriority(PRIO_PROCESS, tid);
+          if (errno == 0
+              && setpriority(PRIO_PROCESS, tid, ADAPTEST_BENCH_NICE) == 0) {
+            niced = true;
+          } else {
+            warnings.push_back(format("could not set nice value {}",
+                                      ADAPTEST_BENCH_NICE));
+          }
+        }
+      #else
+        if (cpu >= 0 || priority) {
+          warnings.push_back("pinning and priority require Linux");
+        }
+      #endif
+    }
+
+    ~BenchPinning() {
+      #ifdef __linux__
+        if (pinned) sched_setaffinity(0, sizeof(previous), &previous);
+        if (niced) {
+          setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+                      previousNice);
+        }
+      #endif
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // the state of the cpu a benchmark runs on, read from sysfs and /proc
+  class BenchEnvironment {
+  private:
+    struct CpuTimes {
+      unsigned long long busy;
+      unsigned long long total;
+    };
+
+    std::vector<CpuTimes> before;
+
+    static std::string read_line(const std::string& path) {
+      std::ifstream file(path.c_str());
+      std::string line;
+      std::getline(file, line);
+      return line;
+    }
+
+    // "0-1,8" to 0, 1, 8
+    static std::vector<int> parse_list(const std::string& list) {
+      std::vector<int> cpus;
+      std::stringstream in(list);
+      std::string range;
+      while (std::getline(in, range, ',')) {
+        if (range.empty()) continue;
+        const size_t dash = range.find('-');
+        const int first = std::atoi(range.c_str());
+        const int last = dash == std::string::npos
+          ? first : std::atoi(range.c_str() + dash + 1);
+        for (int c = first; c <= last; ++c) cpus.push_back(c);
+      }
+      return cpus;
+    }
+
+    static CpuTimes read_times(int cpu) {
+      CpuTimes times = { 0, 0 };
+      std::ifstream stat("/proc/stat");
+      const std::string name = format("cpu{}", cpu);
+      std::string line;
+      while (std::getline(stat, line)) {
+        std::stringstream fields(line);
+        std::string label;
+        fields >> label;
+        if (label != name) continue;
+        // user nice system idle iowait irq softirq steal
+        unsigned long long value;
+        for (int i = 0; fields >> value; ++i) {
+          times.total += value;
+          if (i != 3 && i != 4) times.busy += value;
+        }
+        break;
+      }
+      return times;
+    }
+
+  public:
+    int cpu;
+    std::string governor;
+    int turbo;  // 1 on, 0 off, -1 unknown
+    std::vector<int> siblings;
+    std::vector<double> siblingLoad;
+
+    BenchEnvironment() : cpu(-1), turbo(-1) {}
+
+    // read the settings of the cpu the calling thread runs on
+    void probe() {
+      #ifdef __linux__
+        cpu = sched_getcpu();
+        if (cpu < 0) return;
+        const std::string base = format("/sys/devices/system/cpu/cpu{}/", cpu);
+        governor = read_line(base + "cpufreq/scaling_governor");
+
+        const std::string noTurbo =
+          read_line("/sys/devices/system/cpu/intel_pstate/no_turbo");
+        const std::string boost =
+          read_line("/sys/devices/system/cpu/cpufreq/boost");
+        if (!noTurbo.empty())    turbo = noTurbo == "0";
+        else if (!boost.empty()) turbo = boost == "1";
+
+        siblings = parse_list(
+          read_line(base + "topology/thread_siblings_list"));
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), cpu),
+                       siblings.end());
+        before.clear();
+        for (size_t i = 0; i < siblings.size(); ++i) {
+          before.push_back(read_times(siblings[i]));
+        }
+      #endif
+    }
+
+    // measure the sibling load since probe()
+    void finish() {
+      siblingLoad.clear();
+      for (size_t i = 0; i < siblings.size(); ++i) {
+        const CpuTimes after = read_times(siblings[i]);
+        const double total = static_cast<double>(after.total - before[i].total);
+        siblingLoad.push_back(
+          total > 0 ? (after.busy - before[i].busy) / total : 0);
+      }
+    }
+
+    std::string describe() const {
+      std::stringstream out;
+      out << "cpu " << cpu
+          << ", governor " << (governor.empty() ? "unknown" : governor)
+          << ", turbo " << (turbo < 0 ? "unknown" : turbo ? "on" : "off");
+      for (size_t i = 0; i < siblingLoad.size(); ++i) {
+        out << ", smt sibling " << siblings[i] << " busy "
+            << static_cast<int>(siblingLoad[i] * 100) << "%";
+      }
+      return out.str();
+    }
+
+    std::vector<std::string> warnings() const {
+      std::vector<std::string> found;
+      if (!governor.empty() && governor != "performance") {
+        found.push_back(format("cpu frequency governor is {}", governor));
+      }
+      if (turbo == 1) found.push_back("turbo is enabled");
+      for (size_t i = 0; i < siblingLoad.size(); ++i) {
+        if (siblingLoad[i] > ADAPTEST_BENCH_SIBLING_LOAD) {
+          found.push_back(format("smt sibling {} was {}% busy", siblings[i],
+            static_cast<int>(siblingLoad[i] * 100)));
+        }
+      }
+      return found;
+    }
+  };
+
+  // ================================================================
+
+  // Benchmark Testcase
+  // ------------------
+
+  class BenchmarkTestcase : public virtual Testcase {
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    size_t bench_samples;
+    double bench_alpha;
+    double bench_threshold;
+    int bench_cpu;
+    bool bench_priority;
+    double bench_noise;
+
+    BenchmarkTestcase()
+    : bench_samples(ADAPTEST_BENCH_SAMPLES)
+    , bench_alpha(ADAPTEST_BENCH_ALPHA)
+    , bench_threshold(ADAPTEST_BENCH_THRESHOLD)
+    , bench_cpu(ADAPTEST_BENCH_CPU)
+    , bench_priority(ADAPTEST_BENCH_PRIORITY)
+    , bench_noise(ADAPTEST_BENCH_NOISE)
+    {}
+
+    template <class Callable>
+    Result test_bench(Callable callable, std::string name, const int line)
+    {
+      return test_bench(1, callable, name, line);
+    }
+
+    // benchmark callable and compare against its baseline. the baseline is
+    // recorded if it doesn't exist yet.
+    template <class Callable>
+    Result test_bench(
+      size_t iterations, Callable callable, std::string name, const int line)
+    {
+      std::vector<Bench> single(1, make_bench(name, iterations, callable));
+      return run_benches(single, name, line);
+    }
+
+    // add a benchmark which is run by the next test_benches()
+    template <class Callable>
+    void add_bench(std::string name, size_t iterations, Callable callable)
+    {
+      pending.push_back(make_bench(name, iterations, callable));
+    }
+
+    // run the added benchmarks with their samples interleaved and compare
+    // each against its baseline. the first failure is returned.
+    Result test_benches(std::string name, const int line)
+    {
+      std::vector<Bench> benches;
+      benches.swap(pending);
+      if (benches.empty()) {
+        std::string msg = format("{}: no benchmarks added", name);
+        return error(msg, line);
+      }
+      return run_benches(benches, name, line);
+    }
+
+  private:
+    struct Bench {
+      std::string name;
+      // the runtime of one sample in nanoseconds per call
+      std::function<double()> measure;
+      Samples samples;
+    };
+
+    std::vector<Bench> pending;
+
+    // the timed loop is built around the concrete callable, so it is not
+    // called through std::function
+    template <class Callable>
+    static Bench make_bench(
+      const std::string& name, size_t iterations, Callable callable)
+    {
+      Bench bench;
+      bench.name = name;
+      bench.measure = [iterations, callable]() mutable -> double {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) callable();
+        const Clock::time_point end = Clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count()
+          / iterations;
+      };
+      return bench;
+    }
+
+    // samples round robin, every round starts with another benchmark
+    Result run_benches(std::vector<Bench>& benches, std::string& name,
+                       const int line)
+    {
+      BenchPinning pinning(bench_cpu, bench_priority);
+      BenchEnvironment environment;
+      environment.probe();
+
+      const size_t n = benches.size();
+      for (size_t b = 0; b < n; ++b) benches[b].measure();  // warm up
+      for (size_t s = 0; s < bench_samples; ++s) {
+        for (size_t k = 0; k < n; ++k) {
+          Bench& bench = benches[(s + k) % n];
+          bench.samples.push_back(bench.measure());
+        }
+      }
+      environment.finish();
+
+      std::vector<std::string> warnings = environment.warnings();
+      warnings.insert(warnings.end(), pinning.warnings.begin(),
+                      pinning.warnings.end());
+      record_info(format("{}: {}", name, environment.describe()), line);
+      for (size_t w = 0; w < warnings.size(); ++w) {
+        record_info(format("{}: warning: {}", name, warnings[w]), line);
+      }
+
+      Result first = OK;
+      for (size_t b = 0; b < n; ++b) {
+        Result res = compare_baseline(benches[b].samples, benches[b].name, line);
+        if (res != OK && first == OK) first = res;
+        else if (res != OK) record_info(res.msg, line);
+      }
+      return first;
+    }
+
+  public:
+    //--------------------------------------------------------------------------
+
+    Result compare_baseline(
+      const Samples& current, std::string& name, const int line)
+    {
+      const std::string suite = getTestsuite().getName();
+      const std::string baseline_filename = format(
+        ADAPTEST_BENCH_BASELINE_FILENAME_FORMAT, suite, getName(), name);
+
+      Samples baseline;
+      const char* update = std::getenv(ADAPTEST_BENCH_UPDATE_ENV);
+      if (!(update && *update)) read_samples(baseline_filename, baseline);
+
+      const double current_median = median(current);
+      const double baseline_median = median(baseline);
+      const double cv = coefficient_of_variation(current);
+      const bool unreliable = cv > bench_noise;
+
+      Result res = write_trend(name, current_median, baseline_median, line);
+      if (res != OK) return res;
+
+      if (baseline.empty()) {
+        if (!write_samples(baseline_filename, current)) {
+          std::string msg = format("could not write {}", baseline_filename);
+          return error(msg, line);
+        }
+        record_info(format("{}: recorded baseline, median {} ns, cv {}%{}",
+                           name, current_median, cv * 100,
+                           unreliable ? ", unreliable" : ""), line);
+        return OK;
+      }
+
+      const double p = mann_whitney_p(baseline, current);
+      const double shift = hodges_lehmann(baseline, current);
+      const double relative = baseline_median > 0 ? shift / baseline_median : 0;
+
+      std::stringstream report;
+      report
+        << name << ": median " << current_median << " ns, baseline "
+        << baseline_median << " ns, shift " << (relative * 100)
+        << "%, p=" << p << ", cv " << (cv * 100) << "%";
+      if (unreliable) {
+        report << ", unreliable: cv above " << (bench_noise * 100) << "%";
+      }
+
+      if (p < bench_alpha && relative > bench_threshold) {
+        return Result(FAILED, name, line, "slower than baseline: " + report.str());
+      }
+
+      record_info(report.str(), line);
+      return OK;
+    }
+
+    //--------------------------------------------------------------------------
+
+    static bool read_samples(const std::string& filename, Samples& samples)
+    {
+      std::ifstream file(filename.c_str());
+      if (!file.good()) return false;
+
+      std::string row;
+      while (std::getline(file, row)) {
+        if (row.empty() || row[0] == '#') continue;
+        samples.push_back(std::strtod(row.c_str(), 0));
+      }
+      return true;
+    }
+
+    static bool write_samples(const std::string& filename, const Samples& samples)
+    {
+      std::ofstream file(filename.c_str());
+      if (!file.good()) return false;
+
+      file << "# adaptest baseline, nanoseconds per call" << std::endl;
+      file.precision(17);
+      for (size_t i = 0; i < samples.size(); ++i) {
+        file << samples[i] << std::endl;
+      }
+      return file.good();
+    }
+
+    // append the medians of this run to the trend file and plot all runs
+    Result write_trend(
+      std::string& name, double current, double baseline, const int line)
+    {
+      const std::string suite = getTestsuite().getName();
+      const std::string trend_filename = format(
+        ADAPTEST_BENCH_TREND_FILENAME_FORMAT, suite, getName(), name);
+      ArtifactObservation observation(trend_filename);
+
+      std::vector<std::string> rows;
+      {
+        std::ifstream trend(trend_filename.c_str());
+        std::string row;
+        while (std::getline(trend, row)) {
+          if (!row.empty()) rows.push_back(row);
+        }
+      }
+
+      std::stringstream row;
+      row << rows.size() << "," << current << ",";
+      if (baseline > 0) row << baseline;
+      else              row << current;
+      rows.push_back(row.str());
+
+      std::ofstream trend(trend_filename.c_str(), std::ios::app);
+      if (!trend.good()) {
+        std::string msg = format("could not open {}", trend_filename);
+        return error(msg, line);
+      }
+      trend << rows.back() << std::endl;
+
+      const std::string html_filename = format(
+        ADAPTEST_BENCH_HTML_FILENAME_FORMAT, suite, getName(), name);
+      std::ofstream html(html_filename.c_str());
+      if (!html.good()) {
+        std::string msg = format("could not open {}", html_filename);
+        return error(msg, line);
+      }
+
+      DygraphHtml::write_header(html);
+      for (size_t i = 0; i < rows.size(); ++i) {
+        if (i > 0) html << ",";
+        html << "[" << rows[i] << "]" << std::endl;
+      }
+
+      std::string labels;
+      DygraphHtml::add_label(labels, "Run");
+      DygraphHtml::add_label(labels, "median [ns]");
+      DygraphHtml::add_label(labels, "baseline [ns]");
+      DygraphHtml::write_footer(html, labels);
+
+      return OK;
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_BENCH_H
@@ -24,7 +24,31 @@
 #define ADAPTEST_BUFWRITE_HTML_FILENAME_FORMAT "{}-{}.html"
 #endif // !ADAPTEST_BUFWRITE_HTML_FILENAME_FORMAT
 
+// the html page loads its data from side files, each holding one tile of one
+// zoom level. arguments are testsuite, testcase, level and tile.
+#ifndef ADAPTEST_BUFWRITE_HTML_TILE_FILENAME_FORMAT
+#define ADAPTEST_BUFWRITE_HTML_TILE_FILENAME_FORMAT "{}-{}.{}-{}.js"
+#endif // !ADAPTEST_BUFWRITE_HTML_TILE_FILENAME_FORMAT
+
+// maximal number of min/max buckets plotted at once
+#ifndef ADAPTEST_BUFWRITE_HTML_POINTS
+#define ADAPTEST_BUFWRITE_HTML_POINTS 4096
+#endif // !ADAPTEST_BUFWRITE_HTML_POINTS
+
+// factor between the bucket widths of two zoom levels
+#ifndef ADAPTEST_BUFWRITE_HTML_ZOOM
+#define ADAPTEST_BUFWRITE_HTML_ZOOM 4
+#endif // !ADAPTEST_BUFWRITE_HTML_ZOOM
+
+// number of buckets per side file, must not be less than
+// ADAPTEST_BUFWRITE_HTML_POINTS
+#ifndef ADAPTEST_BUFWRITE_HTML_TILE
+#define ADAPTEST_BUFWRITE_HTML_TILE 16384
+#endif // !ADAPTEST_BUFWRITE_HTML_TILE
+
 #if ADAPTEST_BUFWRITE_FILE
+#include <adaptest/dygraph.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -60,28 +84,36 @@ namespace ADAPTEST_NAMESPACE {
     const int line;
     Testcase& testcase;
 
+    // the names are copied, as the writer may outlive the testcase
+    std::string testsuiteName;
+    std::string testcaseName;
+
     virtual Result write() = 0;
 
     BufferWriter(const int _line, class Testcase& _testcase)
     : line(_line)
     , testcase(_testcase)
+    , testsuiteName(_testcase.getTestsuite().getName())
+    , testcaseName(_testcase.getName())
     {}
 
+    virtual ~BufferWriter() {}
+
     void add_buf(const T* buf, const size_t buflen, std::string name)
     {
       data.push_back(Buffer(name, buf, buflen));
     }
 
     Result error(std::string errmsg) {
-      return testcase.error(errmsg, line);
+      return Result(ERROR, "", line, errmsg);
     }
 
     const char * getTestcaseName() {
-      return testcase.getName().c_str();
+      return testcaseName.c_str();
     }
 
     const char * getTestsuiteName() {
-      return testcase.getTestsuite().getName().c_str(); 
+      return testsuiteName.c_str(); 
     }
   };
 
@@ -115,7 +147,7 @@ namespace ADAPTEST_NAMESPACE {
             Buffer& data = *it;
             datafile << data.buf[i];
           }
-          datafile << std::endl;
+          datafile << "\n";
         }
 
         return OK;
@@ -142,64 +174,100 @@ namespace ADAPTEST_NAMESPACE {
         return OK;
       }
 
-      virtual Result write_html(std::ostream& html, string& filename)
+      // write the buffers min/max decimated into tiles of at most
+      // ADAPTEST_BUFWRITE_HTML_TILE buckets. zoom level n has a bucket width
+      // of ADAPTEST_BUFWRITE_HTML_ZOOM^n samples, the coarsest level fits in
+      // ADAPTEST_BUFWRITE_HTML_POINTS buckets and thus into one tile.
+      virtual Result write_tiles(size_t& levels)
       {
-        html <<
-          "<html><head>"
-          "<script type=\"text/javascript\""
-          "  src=\"dygraph.js\"></script>"
-          "  <style type=\"text/css\">body, div {padding: 0;margin: 0;}</style>"
-          "</head><body>"
-          "<div id=\"graphdiv\"></div>"
-          "<script type=\"text/javascript\">"
-          "  function getData() {return [";
+        const size_t buflen = getData().begin()->buflen;
+        const size_t zoom = ADAPTEST_BUFWRITE_HTML_ZOOM;
+        const size_t tilelen = ADAPTEST_BUFWRITE_HTML_TILE;
+
+        levels = 0;
+        for (size_t width = 1; 
+             (buflen + width - 1) / width > ADAPTEST_BUFWRITE_HTML_POINTS; 
+             width *= zoom) {
+          levels++;
+        }
 
-        int bufidx = 0;
-        BufferListIter begin = getData().begin();
-        for (BufferListIter i = begin; i != getData().end(); ++i)
+        size_t width = 1;
+        for (size_t level = 0; level <= levels; ++level, width *= zoom)
         {
-          if (i != begin) html << ", ";
-
-          // write the data columwise
-          const size_t buflen = begin->buflen;
-          for (int i = 0; i < buflen; ++i)
+          const size_t buckets = (buflen + width - 1) / width;
+          // an empty buffer still gets the empty tile the page loads first
+          for (size_t tile = 0; tile == 0 || tile * tilelen < buckets; ++tile)
           {
-            if (i > 0) html << ",";
-            html << "[ " << i << ", ";
-            for (BufferListIter it = begin; it != getData().end(); ++it)
+            string tile_filename = format(
+              ADAPTEST_BUFWRITE_HTML_TILE_FILENAME_FORMAT, 
+              getTestsuiteName(), getTestcaseName(), level, tile);
+
+            std::fstream tilefile(tile_filename, std::ios::out);
+            if (!tilefile.good()) {
+              return error(format("could not open {}", tile_filename));
+            }
+
+            tilefile << "adaptest_tile(" << level << "," << tile << ",[";
+
+            const size_t first = tile * tilelen;
+            const size_t last = std::min(buckets, first + tilelen);
+            for (size_t b = first; b < last; ++b)
             {
-              if (it != begin) html << ",";
-              Buffer& data = *it;
-              html << data.buf[i];
+              const size_t from = b * width;
+              const size_t to = std::min(buflen, from + width);
+
+              if (b != first) tilefile << ",";
+              tilefile << "[" << from;
+              for (BufferListIter it = getData().begin(); it != getData().end(); ++it)
+              {
+                const T* buf = it->buf;
+
+                // the page expands single samples to [min, mean, max]
+                if (width == 1) {
+                  tilefile << "," << buf[from];
+                  continue;
+                }
+
+                T lo = buf[from], hi = buf[from];
+                double sum = 0;
+                for (size_t i = from; i < to; ++i)
+                {
+                  if (buf[i] < lo) lo = buf[i];
+                  if (hi < buf[i]) hi = buf[i];
+                  sum += buf[i];
+                }
+                tilefile 
+                  << ",[" << lo << "," << sum / (to - from) << "," << hi << "]";
+              }
+              tilefile << "]\n";
             }
-            html << "] " << std::endl;
-          }
 
-          bufidx++;
+            tilefile << "]);" << std::endl;
+          }
         }
 
-        html <<
-          "  ];}"
-          "  (function() {"
-          "  var w = window, d = document, e = d.documentElement, "
-          "      g = d.getElementsByTagName('body')[0],"
-          "      width = w.innerWidth || e.clientWidth || g.clientWidth,"
-          "      height = w.innerHeight|| e.clientHeight|| g.clientHeight;"
-          "  g = new Dygraph(document.getElementById(\"graphdiv\"), getData, {"
-          "      width: width,"
-          "      height: height,"
-          "      labels: [ \"Index\", ";
+        return OK;
+      }
+
+      virtual Result write_html(std::ostream& html)
+      {
+        size_t levels = 0;
+        Result res = write_tiles(levels);
+        if (res != OK) return res;
 
+        string labels;
+        DygraphHtml::add_label(labels, "Index");
         for (BufferListIter it = getData().begin(); it != getData().end(); ++it)
         {
-          Buffer& data = *it;
-          if (it != getData().begin()) html << ", ";
-          html << "\"" << data.name << "\"";
+          DygraphHtml::add_label(labels, it->name);
         }
 
-        html <<
-          " ],"
-          "    });})();</script></body></html>";
+        DygraphHtml::write_tiled(html, labels, 
+          format(ADAPTEST_BUFWRITE_HTML_TILE_FILENAME_FORMAT, 
+                 getTestsuiteName(), getTestcaseName(), "%L", "%T"),
+          getData().begin()->buflen, levels, 
+          ADAPTEST_BUFWRITE_HTML_ZOOM, ADAPTEST_BUFWRITE_HTML_TILE,
+          ADAPTEST_BUFWRITE_HTML_POINTS);
 
         return OK;
       }      
@@ -209,6 +277,7 @@ namespace ADAPTEST_NAMESPACE {
         string filename = format(
           ADAPTEST_BUFWRITE_CSV_FILENAME_FORMAT,
           getTestsuiteName(), getTestcaseName());
+        ArtifactObservation observation(filename);
 
         std::fstream datafile(filename, std::ios::out);
         
@@ -238,9 +307,7 @@ namespace ADAPTEST_NAMESPACE {
 
         write_buffers(datafile);
         write_gnuplot(gnuplot_file, filename);
-        write_html(html_file, filename);
-
-        return OK;
+        return write_html(html_file);
       }
     };
 
@@ -0,0 +1,273 @@
+#ifndef ADAPTEST_CONCURRENT_H
+#define ADAPTEST_CONCURRENT_H
+
+#include <adaptest.h>
+
+// a Testcase Base Class for Adaptest which stresses concurrent code by calling
+// a callable on several threads which start at the same instant. CHECK() may be
+// used on the worker threads, failures are collected into the testcase result.
+// requires C++11.
+
+// pin worker thread N to cpu N (modulo the number of cpus) by default
+#ifndef ADAPTEST_CONCURRENT_PIN
+#define ADAPTEST_CONCURRENT_PIN 0
+#endif // !ADAPTEST_CONCURRENT_PIN
+
+// inject random yields and delays before each iteration by default
+#ifndef ADAPTEST_CONCURRENT_PERTURB
+#define ADAPTEST_CONCURRENT_PERTURB 0
+#endif // !ADAPTEST_CONCURRENT_PERTURB
+
+// environment variable which sets the perturbation seed to replay a run
+#ifndef ADAPTEST_CONCURRENT_SEED_ENV
+#define ADAPTEST_CONCURRENT_SEED_ENV "ADAPTEST_SEED"
+#endif // !ADAPTEST_CONCURRENT_SEED_ENV
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ADAPTEST_NAMESPACE {
+
+  // releases all waiting threads once the last of them arrived
+  class SpinBarrier {
+  private:
+    const size_t count;
+    std::atomic<size_t> waiting;
+
+  public:
+    explicit SpinBarrier(size_t _count)
+    : count(_count)
+    , waiting(0)
+    {}
+
+    void wait() {
+      waiting.fetch_add(1, std::memory_order_acq_rel);
+      for (size_t spins = 1;
+           waiting.load(std::memory_order_acquire) < count; ++spins) {
+        // stay responsive if there are more threads than cpus
+        if ((spins & 1023) == 0) std::this_thread::yield();
+      }
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // handed to the callable of test_concurrent() upon each iteration
+  class ConcurrentContext {
+  private:
+    bool perturbing;
+    unsigned long long state;
+
+  public:
+    const size_t thread;
+    size_t iteration;
+
+    ConcurrentContext(size_t _thread, bool _perturbing, unsigned long long seed)
+    : perturbing(_perturbing)
+    , state((seed + _thread + 1) * 0x9E3779B97F4A7C15ULL)
+    , thread(_thread)
+    , iteration(0)
+    {}
+
+    // randomly yield or spin for a while. does nothing unless perturbation
+    // is enabled. may be called by the tested code at interesting points.
+    void perturb() {
+      if (!perturbing) return;
+
+      // xorshift64
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+
+      switch (state & 7) {
+        case 0:
+          std::this_thread::yield();
+          break;
+        case 1:
+          for (unsigned long long i = (state >> 3) & 1023; i > 0; --i) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  class ConcurrentTestcase : public virtual Testcase {
+  private:
+    std::mutex checkMutex;
+    std::atomic<size_t> checkFailures;
+    // passed checks of the worker threads are only counted, so they don't
+    // serialize the workers
+    std::atomic<bool> workersRunning;
+    std::atomic<size_t> checkPasses;
+
+    static unsigned long long initialSeed() {
+      const char* env = std::getenv(ADAPTEST_CONCURRENT_SEED_ENV);
+      if (env && *env) return std::strtoull(env, 0, 0);
+      std::random_device random;
+      return (static_cast<unsigned long long>(random()) << 32) ^ random();
+    }
+
+  protected:
+    typedef std::chrono::steady_clock Clock;
+
+    static void pin(size_t thread) {
+      #ifdef __linux__
+        const size_t cpus = std::thread::hardware_concurrency();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus ? thread % cpus : 0, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      #endif
+    }
+
+    size_t failed_checks() const { return checkFailures.load(); }
+
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    bool concurrent_pin;
+    bool concurrent_perturb;
+    unsigned long long concurrent_seed;
+
+    ConcurrentTestcase()
+    : checkFailures(0)
+    , workersRunning(false)
+    , checkPasses(0)
+    , concurrent_pin(ADAPTEST_CONCURRENT_PIN)
+    , concurrent_perturb(ADAPTEST_CONCURRENT_PERTURB)
+    , concurrent_seed(initialSeed())
+    {}
+
+    // CHECK() is called from the worker threads, too
+    void record_check(const Result& res) {
+      if (res.resval == OK && workersRunning.load(std::memory_order_relaxed)) {
+        checkPasses.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (res.resval != OK) checkFailures++;
+      std::lock_guard<std::mutex> lock(checkMutex);
+      Testcase::record_check(res);
+    }
+
+    // run callable(ConcurrentContext&) iterations times on each of nthreads
+    // threads, which are released at once. exceptions are recorded as checks.
+    template <class Callable>
+    void run_threads(
+      size_t nthreads, size_t iterations, Callable& callable,
+      std::string& name, const int line,
+      std::vector<Clock::time_point>& started,
+      std::vector<Clock::time_point>& finished)
+    {
+      started.assign(nthreads, Clock::time_point());
+      finished.assign(nthreads, Clock::time_point());
+      std::vector<std::thread> threads;
+      SpinBarrier barrier(nthreads);
+      workersRunning = true;
+
+      for (size_t t = 0; t < nthreads; ++t) {
+        threads.push_back(std::thread([&, t]() {
+          ConcurrentContext ctx(t, concurrent_perturb, concurrent_seed);
+          if (concurrent_pin) pin(t);
+
+          barrier.wait();
+          started[t] = Clock::now();
+          try {
+            for (; ctx.iteration < iterations; ++ctx.iteration) {
+              ctx.perturb();
+              callable(ctx);
+            }
+          } catch (std::exception& e) {
+            record_check(Result(ERROR, name, line, format(
+              "{} threw on thread {}: {}", name, t, e.what())));
+          } catch (...) {
+            record_check(Result(ERROR, name, line, format(
+              "{} threw on thread {}", name, t)));
+          }
+          finished[t] = Clock::now();
+        }));
+      }
+
+      for (size_t t = 0; t < nthreads; ++t) threads[t].join();
+      workersRunning = false;
+      Testcase::record_passed(checkPasses.exchange(0));
+    }
+
+    // call callable(ConcurrentContext&) iterations times on each of nthreads
+    // threads. fails if a CHECK() failed on any of the threads.
+    template <class Callable>
+    Result test_concurrent(
+      size_t nthreads, size_t iterations, Callable callable,
+      std::string name, const int line)
+    {
+      if (!nthreads) {
+        std::string msg = format("{}: nthreads must be > 0", name);
+        return error(msg, line);
+      }
+
+      const size_t failuresBefore = checkFailures.load();
+      std::vector<Clock::time_point> started, finished;
+      run_threads(nthreads, iterations, callable, name, line,
+                  started, finished);
+
+      // per thread throughput and spread of the completion times
+      std::stringstream report;
+      report
+        << name << ": " << nthreads << " threads x " << iterations
+        << " iterations, seed " << concurrent_seed << ", it/ms:"
+        << std::fixed << std::setprecision(1);
+
+      Clock::time_point first = finished[0], last = finished[0];
+      for (size_t t = 0; t < nthreads; ++t) {
+        const double ms = std::chrono::duration<double, std::milli>(
+          finished[t] - started[t]).count();
+        report << " " << (ms > 0 ? iterations / ms : 0.0);
+        if (finished[t] < first) first = finished[t];
+        if (finished[t] > last)  last  = finished[t];
+      }
+
+      report
+        << ", completion spread " << std::setprecision(3)
+        << std::chrono::duration<double, std::milli>(last - first).count()
+        << " ms";
+      record_info(report.str(), line);
+
+      return check_failures(failuresBefore, nthreads, name, line);
+    }
+
+    // fails if CHECK()s failed since failuresBefore
+    Result check_failures(
+      size_t failuresBefore, size_t nthreads, std::string& name,
+      const int line)
+    {
+      const size_t failures = checkFailures.load() - failuresBefore;
+      if (failures) {
+        return Result(FAILED, name, line, format(
+          "{} failed {} checks on {} threads (seed {})",
+          name, failures, nthreads, concurrent_seed));
+      }
+      return OK;
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_CONCURRENT_H
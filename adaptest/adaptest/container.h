@@ -0,0 +1,405 @@
+#ifndef ADAPTEST_CONTAINER_H
+#define ADAPTEST_CONTAINER_H
+
+#include <adaptest.h>
+
+// a Testcase Base Class for Adaptest with test_eq specialised for
+// std::vector, std::basic_string, std::array and C arrays. elements which are
+// equal if their bytes are equal (integers, enums, pointers) are compared by
+// memcmp, containers of different sizes are not compared at all. upon failure
+// a Myers diff reports the differing hunks with some context instead of
+// dumping both containers. strings with newlines are diffed by lines.
+// requires C++11.
+
+// number of equal elements shown around a difference
+#ifndef ADAPTEST_CONTAINER_DIFF_CONTEXT
+#define ADAPTEST_CONTAINER_DIFF_CONTEXT 3
+#endif // !ADAPTEST_CONTAINER_DIFF_CONTEXT
+
+// maximal edit distance the diff searches for, beyond only the first
+// difference is shown
+#ifndef ADAPTEST_CONTAINER_DIFF_MAX_EDITS
+#define ADAPTEST_CONTAINER_DIFF_MAX_EDITS 256
+#endif // !ADAPTEST_CONTAINER_DIFF_MAX_EDITS
+
+// maximal number of hunks shown
+#ifndef ADAPTEST_CONTAINER_DIFF_HUNKS
+#define ADAPTEST_CONTAINER_DIFF_HUNKS 8
+#endif // !ADAPTEST_CONTAINER_DIFF_HUNKS
+
+// strings up to this length are shown whole, longer lines are cut around
+// the first difference
+#ifndef ADAPTEST_CONTAINER_DIFF_WIDTH
+#define ADAPTEST_CONTAINER_DIFF_WIDTH 72
+#endif // !ADAPTEST_CONTAINER_DIFF_WIDTH
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // elements which are equal if and only if their bytes are equal.
+  // specialize for own types without padding.
+  template <class T>
+  struct memcmp_comparable : std::integral_constant<bool,
+    std::is_integral<T>::value || std::is_enum<T>::value
+    || std::is_pointer<T>::value> {};
+
+  // Diff
+  // ----
+
+  // how elements are shown in a diff
+  template <class T>
+  inline std::string show_element(const T& value) {
+    return format("{}", value);
+  }
+
+  inline std::string show_char(int c) {
+    if (c == '\'' || c == '\\') return format("'\\{}'", static_cast<char>(c));
+    if (c >= 0x20 && c < 0x7f) return format("'{}'", static_cast<char>(c));
+    char hex[8];
+    std::snprintf(hex, sizeof(hex), "'\\x%02x'", c & 0xff);
+    return hex;
+  }
+
+  inline std::string show_element(const char& value) {
+    return show_char(static_cast<unsigned char>(value));
+  }
+
+  // bytes of payloads are numbers
+  inline std::string show_element(const signed char& value) {
+    return format("{}", static_cast<int>(value));
+  }
+
+  inline std::string show_element(const unsigned char& value) {
+    return format("{}", static_cast<int>(value));
+  }
+
+  // a line, cut to the width around column
+  inline std::string show_line(const std::string& line, size_t column = 0) {
+    const size_t width = ADAPTEST_CONTAINER_DIFF_WIDTH;
+    size_t first = 0;
+    if (line.size() > width && column > width / 2) {
+      first = column - width / 2;
+      if (first > line.size() - width) first = line.size() - width;
+    }
+    std::string shown = first ? "..." : "";
+    shown += '"';
+    for (size_t i = first; i < line.size() && i < first + width; ++i) {
+      const unsigned char c = line[i];
+      if (c == '"' || c == '\\') { shown += '\\'; shown += c; }
+      else if (c >= 0x20 && c < 0x7f) shown += c;
+      else shown += show_char(c).substr(1, 4);
+    }
+    shown += '"';
+    if (first + width < line.size()) shown += "...";
+    return shown;
+  }
+
+  inline std::string show_element(const std::string& value) {
+    return show_line(value);
+  }
+
+  //--------------------------------------------------------------------------
+
+  // a bounded Myers diff of two random access sequences. only the edits are
+  // stored, the sequences have to outlive the diff.
+  template <class ItA, class ItB>
+  class SequenceDiff {
+  private:
+    struct Edit {
+      bool insert;  // b[y] inserted, else a[x] deleted
+      size_t x;
+      size_t y;
+    };
+
+    ItA a;
+    ItB b;
+    size_t n;
+    size_t m;
+    size_t prefix;
+    std::vector<Edit> edits;
+    bool bounded;
+
+    bool equal(size_t x, size_t y) const { return !(a[x] != b[y]); }
+
+    // the shortest edit script of a[prefix, n - suffix) and
+    // b[prefix, m - suffix), false if it is longer than max_edits
+    bool search(size_t suffix, long max_edits) {
+      const long an = static_cast<long>(n - prefix - suffix);
+      const long bn = static_cast<long>(m - prefix - suffix);
+      const long offset = max_edits + 1;
+      std::vector<long> v(2 * offset + 1, 0);
+      std::vector<std::vector<long> > trace;
+
+      for (long d = 0; d <= max_edits; ++d) {
+        trace.push_back(v);
+        for (long k = -d; k <= d; k += 2) {
+          long x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+            ? v[offset + k + 1] : v[offset + k - 1] + 1;
+          long y = x - k;
+          while (x < an && y < bn && equal(prefix + x, prefix + y)) ++x, ++y;
+          v[offset + k] = x;
+          if (x >= an && y >= bn) {
+            backtrack(trace, offset, d, an, bn);
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    void backtrack(const std::vector<std::vector<long> >& trace, long offset,
+                   long d, long x, long y)
+    {
+      for (; d > 0; --d) {
+        const std::vector<long>& v = trace[d];
+        const long k = x - y;
+        const long prev_k =
+          (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+          ? k + 1 : k - 1;
+        const long prev_x = v[offset + prev_k];
+        const long prev_y = prev_x - prev_k;
+        Edit edit;
+        edit.insert = prev_k == k + 1;
+        edit.x = prefix + prev_x;
+        edit.y = prefix + prev_y;
+        edits.push_back(edit);
+        x = prev_x;
+        y = prev_y;
+      }
+      std::reverse(edits.begin(), edits.end());
+    }
+
+    template <class It>
+    static void line(std::ostream& out, char mark, size_t index, It it) {
+      out << "\n" << mark << " [" << index << "] " << show_element(*it);
+    }
+
+    // the equal elements from (x, y) to (to_x, ...), with the indices of
+    // both sides as "[x|y]"
+    void same(std::ostream& out, size_t& x, size_t& y, size_t to_x) const {
+      for (; x < to_x; ++x, ++y) {
+        out << "\n  [" << x << "|" << y << "] " << show_element(*(a + x));
+      }
+    }
+
+  public:
+    SequenceDiff(ItA _a, size_t _n, ItB _b, size_t _m)
+    : a(_a)
+    , b(_b)
+    , n(_n)
+    , m(_m)
+    , prefix(0)
+    , bounded(true)
+    {
+      while (prefix < n && prefix < m && equal(prefix, prefix)) ++prefix;
+      size_t suffix = 0;
+      while (suffix < n - prefix && suffix < m - prefix
+             && equal(n - 1 - suffix, m - 1 - suffix)) ++suffix;
+      bounded = search(suffix, ADAPTEST_CONTAINER_DIFF_MAX_EDITS);
+    }
+
+    size_t first() const { return prefix; }
+
+    // the differences as hunks of lines "  [i|j] equal", "- [i] expected"
+    // and "+ [j] value", i indexes the expected and j the value side.
+    // hunks are separated by "...".
+    std::string hunks() const {
+      const size_t context = ADAPTEST_CONTAINER_DIFF_CONTEXT;
+      std::stringstream out;
+
+      if (!bounded) {
+        out << "\nmore than " << ADAPTEST_CONTAINER_DIFF_MAX_EDITS
+            << " differences, the first one at [" << prefix << "]:";
+        for (size_t i = prefix; i < n && i < prefix + context + 1; ++i) {
+          line(out, '-', i, a + i);
+        }
+        for (size_t i = prefix; i < m && i < prefix + context + 1; ++i) {
+          line(out, '+', i, b + i);
+        }
+        return out.str();
+      }
+
+      size_t shown = 0;
+      for (size_t e = 0; e < edits.size(); ) {
+        // the edits of one hunk are at most 2 * context apart
+        size_t last = e;
+        for (; last + 1 < edits.size(); ++last) {
+          const Edit& cur = edits[last];
+          const size_t end = cur.insert ? cur.x : cur.x + 1;
+          if (edits[last + 1].x > end + 2 * context) break;
+        }
+
+        if (shown++ == ADAPTEST_CONTAINER_DIFF_HUNKS) {
+          size_t more = 1;
+          for (size_t r = last + 1; r < edits.size(); ++r) {
+            const size_t end = edits[r - 1].insert
+              ? edits[r - 1].x : edits[r - 1].x + 1;
+            if (edits[r].x > end + 2 * context) ++more;
+          }
+          out << "\n... " << more << " more hunks";
+          break;
+        }
+
+        if (e) out << "\n...";
+        size_t x = edits[e].x > context ? edits[e].x - context : 0;
+        size_t y = edits[e].y - (edits[e].x - x);
+        for (size_t i = e; i <= last; ++i) {
+          same(out, x, y, edits[i].x);
+          if (edits[i].insert) line(out, '+', y, b + y), ++y;
+          else                 line(out, '-', x, a + x), ++x;
+        }
+        const size_t end_x = x + context < n ? x + context : n;
+        same(out, x, y, end_x);
+        e = last + 1;
+      }
+      return out.str();
+    }
+  };
+
+  template <class ItA, class ItB>
+  inline std::string diff_sequences(ItA a, size_t n, ItB b, size_t m) {
+    return SequenceDiff<ItA, ItB>(a, n, b, m).hunks();
+  }
+
+  // ================================================================
+
+  // Container Testcase
+  // ------------------
+
+  class ContainerTestcase : public virtual Testcase {
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    // make test_eq overridable
+    using Testcase::test_eq;
+
+    template <class T, class AllocA, class AllocB>
+    Result test_eq(
+      const std::vector<T, AllocA>& expected,
+      const std::vector<T, AllocB>& value, std::string name, const int line)
+    {
+      return test_range(expected.begin(), expected.size(),
+                        value.begin(), value.size(), name, line);
+    }
+
+    template <class T, size_t N>
+    Result test_eq(
+      const std::array<T, N>& expected, const std::array<T, N>& value,
+      std::string name, const int line)
+    {
+      return test_range(expected.begin(), N, value.begin(), N, name, line);
+    }
+
+    // string literals are arrays too, they are compared with their '\0'
+    template <class T, size_t N, size_t M>
+    Result test_eq(
+      const T (&expected)[N], const T (&value)[M],
+      std::string name, const int line)
+    {
+      return test_range(expected, N, value, M, name, line);
+    }
+
+    template <class C, class Traits, class AllocA, class AllocB>
+    Result test_eq(
+      const std::basic_string<C, Traits, AllocA>& expected,
+      const std::basic_string<C, Traits, AllocB>& value,
+      std::string name, const int line)
+    {
+      if (expected.size() == value.size()
+          && Traits::compare(expected.data(), value.data(), value.size()) == 0)
+      {
+        return OK;
+      }
+      return fail_string(expected, value, name, line);
+    }
+
+  private:
+    // memcmp for contiguous byte comparable elements, != otherwise
+    template <class ItA, class ItB>
+    static bool equal_elements(ItA a, ItB b, size_t n, std::false_type) {
+      for (size_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) return false;
+      }
+      return true;
+    }
+
+    template <class ItA, class ItB>
+    static bool equal_elements(ItA a, ItB b, size_t n, std::true_type) {
+      return std::memcmp(&a[0], &b[0], n * sizeof(a[0])) == 0;
+    }
+
+    template <class ItA, class ItB>
+    Result test_range(
+      ItA expected, size_t n, ItB value, size_t m,
+      std::string& name, const int line)
+    {
+      typedef typename std::iterator_traits<ItA>::value_type T;
+      // vector<bool> isn't contiguous
+      typedef std::integral_constant<bool, memcmp_comparable<T>::value
+        && !std::is_same<T, bool>::value> Bytewise;
+
+      if (n == m && (!n || equal_elements(expected, value, n, Bytewise()))) {
+        return OK;
+      }
+      return Result(FAILED, name, line, format(
+        "{} differs, expected {} elements, got {}:{}", name, n, m,
+        diff_sequences(expected, n, value, m)));
+    }
+
+    template <class C, class Traits, class AllocA, class AllocB>
+    Result fail_string(
+      const std::basic_string<C, Traits, AllocA>& expected,
+      const std::basic_string<C, Traits, AllocB>& value,
+      std::string& name, const int line)
+    {
+      const bool multiline = expected.find(C('\n')) != expected.npos
+                          || value.find(C('\n')) != value.npos;
+      if (!multiline || sizeof(C) != 1) {
+        size_t at = 0;
+        while (at < expected.size() && at < value.size()
+               && Traits::eq(expected[at], value[at])) ++at;
+        if (sizeof(C) == 1) {
+          const std::string e(expected.begin(), expected.end());
+          const std::string v(value.begin(), value.end());
+          return Result(FAILED, name, line, format(
+            "{} expected to be {}, but is {}, first difference at [{}]",
+            name, show_line(e, at), show_line(v, at), at));
+        }
+        return Result(FAILED, name, line, format(
+          "{} differs, expected {} characters, got {}:{}",
+          name, expected.size(), value.size(),
+          diff_sequences(expected.begin(), expected.size(),
+                         value.begin(), value.size())));
+      }
+
+      const std::vector<std::string> a = split_lines(expected);
+      const std::vector<std::string> b = split_lines(value);
+      return Result(FAILED, name, line, format(
+        "{} differs, expected {} lines, got {}:{}", name, a.size(), b.size(),
+        diff_sequences(a.begin(), a.size(), b.begin(), b.size())));
+    }
+
+    template <class S>
+    static std::vector<std::string> split_lines(const S& text) {
+      std::vector<std::string> lines(1);
+      for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') lines.push_back("");
+        else                 lines.back() += static_cast<char>(text[i]);
+      }
+      return lines;
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_CONTAINER_H
@@ -0,0 +1,175 @@
+#ifndef ADAPTEST_DYGRAPH_H
+#define ADAPTEST_DYGRAPH_H
+
+#include <adaptest.h>
+
+// writes HTML pages which plot data using the dygraph.js library from the
+// vendor folder. dygraph.js has to be copied next to the written html files.
+
+#include <ostream>
+#include <string>
+
+namespace ADAPTEST_NAMESPACE {
+
+  class DygraphHtml {
+  public:
+    // writes everything up to the data array returned by getData(). the data
+    // has to follow as comma separated rows like "[x, y1, y2]"
+    static void write_header(std::ostream& html)
+    {
+      html <<
+        "<html><head>"
+        "<script type=\"text/javascript\""
+        "  src=\"dygraph.js\"></script>"
+        "  <style type=\"text/css\">body, div {padding: 0;margin: 0;}</style>"
+        "</head><body>"
+        "<div id=\"graphdiv\"></div>"
+        "<script type=\"text/javascript\">"
+        "  function getData() {return [";
+    }
+
+    // closes the data array and creates the graph. labels is the comma
+    // separated list of quoted column names, options are further dygraph
+    // options like "logscale: true,"
+    static void write_footer(
+      std::ostream& html, const std::string& labels,
+      const std::string& options = "")
+    {
+      html <<
+        "  ];}"
+        "  (function() {"
+        "  var w = window, d = document, e = d.documentElement, "
+        "      g = d.getElementsByTagName('body')[0],"
+        "      width = w.innerWidth || e.clientWidth || g.clientWidth,"
+        "      height = w.innerHeight|| e.clientHeight|| g.clientHeight;"
+        "  g = new Dygraph(document.getElementById(\"graphdiv\"), getData, {"
+        "      width: width,"
+        "      height: height,"
+        << options <<
+        "      labels: [ " << labels << " ],"
+        "    });})();</script></body></html>";
+    }
+
+    // writes a page which loads its data from side files. each side file
+    // holds one tile of one zoom level and calls
+    //   adaptest_tile(level, tile, [[x, [min, mean, max], ...], ...]);
+    // level 0 holds the samples itself: [x, value, ...]
+    // pattern is the side file name containing %L for the level and %T for
+    // the tile. level n has a bucket width of zoom^n samples, the page always
+    // shows the finest level which has at most points buckets in view.
+    static void write_tiled(
+      std::ostream& html, const std::string& labels,
+      const std::string& pattern, size_t length, size_t levels,
+      size_t zoom, size_t tile, size_t points)
+    {
+      html <<
+        "<html><head>"
+        "<script type=\"text/javascript\""
+        "  src=\"dygraph.js\"></script>"
+        "  <style type=\"text/css\">body, div {padding: 0;margin: 0;}</style>"
+        "</head><body>"
+        "<div id=\"graphdiv\"></div>"
+        "<script type=\"text/javascript\">\n"
+        "var adaptest = {"
+        "  pattern: \"" << pattern << "\","
+        "  length: " << length << ","
+        "  levels: " << levels << ","
+        "  zoom: " << zoom << ","
+        "  tile: " << tile << ","
+        "  points: " << points << ","
+        "  tiles: {}, requested: {}, view: null, graph: null };\n"
+        "function adaptest_load(level, tile) {"
+        "  var key = level + '-' + tile;"
+        "  if (adaptest.requested[key]) return;"
+        "  adaptest.requested[key] = true;"
+        "  var s = document.createElement('script');"
+        "  s.src = adaptest.pattern.replace('%L', level).replace('%T', tile);"
+        "  document.body.appendChild(s);"
+        "}\n"
+        "function adaptest_tile(level, tile, rows) {"
+        "  if (level == 0) {"
+        "    for (var i = 0; i < rows.length; ++i) {"
+        "      for (var j = 1; j < rows[i].length; ++j) {"
+        "        rows[i][j] = [rows[i][j], rows[i][j], rows[i][j]];"
+        "      }"
+        "    }"
+        "  }"
+        "  adaptest.tiles[level + '-' + tile] = rows;"
+        "  adaptest_show();"
+        "}\n"
+        // rows of level between lo and hi, null while tiles are loading
+        "function adaptest_rows(level, lo, hi) {"
+        "  var width = Math.pow(adaptest.zoom, level),"
+        "      span = width * adaptest.tile, rows = [], missing = false;"
+        "  for (var t = Math.max(0, Math.floor(lo / span));"
+        "       t <= Math.floor(hi / span); ++t) {"
+        "    var tile = adaptest.tiles[level + '-' + t];"
+        "    if (tile === undefined) {"
+        "      if (t * span < adaptest.length) {"
+        "        adaptest_load(level, t); missing = true;"
+        "      }"
+        "      continue;"
+        "    }"
+        "    for (var i = 0; i < tile.length; ++i) {"
+        "      if (tile[i][0] + width > lo && tile[i][0] <= hi) rows.push(tile[i]);"
+        "    }"
+        "  }"
+        "  return missing ? null : rows;"
+        "}\n"
+        "function adaptest_show() {"
+        "  var a = adaptest, overview = a.tiles[a.levels + '-0'];"
+        "  if (overview === undefined) return;"
+        "  var view = a.view || [0, a.length], level = 0;"
+        "  while (level < a.levels &&"
+        "         (view[1] - view[0]) / Math.pow(a.zoom, level) > a.points) {"
+        "    level++;"
+        "  }"
+        "  var fine = adaptest_rows(level, view[0], view[1]);"
+        "  if (fine === null) return;"
+        // keep the overview outside of the view to allow panning
+        "  var rows = [], i;"
+        "  var lo = fine.length ? fine[0][0] : view[0],"
+        "      hi = fine.length ? fine[fine.length - 1][0] : view[1];"
+        "  for (i = 0; i < overview.length && overview[i][0] < lo; ++i) {"
+        "    rows.push(overview[i]);"
+        "  }"
+        "  rows = rows.concat(fine);"
+        "  for (i = 0; i < overview.length; ++i) {"
+        "    if (overview[i][0] > hi) rows.push(overview[i]);"
+        "  }"
+        "  if (a.graph) {"
+        "    var options = { file: rows };"
+        "    if (a.view) options.dateWindow = a.view;"
+        "    a.graph.updateOptions(options);"
+        "    return;"
+        "  }"
+        "  var w = window, d = document, e = d.documentElement, "
+        "      g = d.getElementsByTagName('body')[0],"
+        "      width = w.innerWidth || e.clientWidth || g.clientWidth,"
+        "      height = w.innerHeight|| e.clientHeight|| g.clientHeight;"
+        "  a.graph = new Dygraph(document.getElementById(\"graphdiv\"), rows, {"
+        "      width: width,"
+        "      height: height,"
+        "      customBars: true,"
+        "      zoomCallback: function(lo, hi) {"
+        "        a.view = a.graph.isZoomed('x') ? [lo, hi] : null;"
+        "        adaptest_show();"
+        "      },"
+        "      labels: [ " << labels << " ],"
+        "    });"
+        "}\n"
+        "adaptest_load(adaptest.levels, 0);"
+        "</script></body></html>";
+    }
+
+    // appends a quoted label to a label list
+    static void add_label(std::string& labels, const std::string& label)
+    {
+      if (!labels.empty()) labels += ", ";
+      labels += "\"" + label + "\"";
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_DYGRAPH_H
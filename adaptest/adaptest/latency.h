@@ -0,0 +1,236 @@
+#ifndef ADAPTEST_LATENCY_H
+#define ADAPTEST_LATENCY_H
+
+#include <adaptest.h>
+#include <adaptest/buf.h>
+
+// a Testcase Base Class for Adaptest which records the latency of every call
+// of a callable into a log bucketed histogram (HDR style, fixed memory, no
+// allocation while recording) and fails if the median or the 99th percentile
+// exceeds its budget. upon failure the histogram is passed to WriterPolicy,
+// the same way BufferTestcase does with failed buffers. requires C++11.
+//
+//   class MyTestcase
+//     : public AdapTest::LatencyTestcase<AdapTest::CSVBufferWriter> {};
+//   ...
+//   TEST(latency, [&]() { lookup(key); }, 100000,
+//        std::chrono::microseconds(1), std::chrono::microseconds(20), "lookup")
+
+// every power of two is divided into 2^(bits-1) buckets, so the relative
+// error of a recorded value is below 2^-(bits-1)
+#ifndef ADAPTEST_LATENCY_PRECISION_BITS
+#define ADAPTEST_LATENCY_PRECISION_BITS 7
+#endif // !ADAPTEST_LATENCY_PRECISION_BITS
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Histogram
+  // ---------
+
+  // counts values in nanoseconds. values below 2^bits have buckets of their
+  // own, above every power of two has half as many buckets.
+  class LatencyHistogram {
+  public:
+    typedef unsigned long long Value;
+
+    static const int bits = ADAPTEST_LATENCY_PRECISION_BITS;
+    static const size_t linear = size_t(1) << bits;
+    static const size_t half = linear / 2;
+    static const size_t buckets = linear + (64 - bits) * half;
+
+  private:
+    Value counts[buckets];
+    Value total;
+    Value minimum;
+    Value maximum;
+    double sum;
+
+    static int msb(Value v) {
+      #if defined(__GNUC__)
+        return 63 - __builtin_clzll(v);
+      #else
+        int n = 0;
+        while (v >>= 1) ++n;
+        return n;
+      #endif
+    }
+
+  public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+      std::memset(counts, 0, sizeof(counts));
+      total = 0;
+      minimum = ~Value(0);
+      maximum = 0;
+      sum = 0;
+    }
+
+    static size_t index(Value v) {
+      if (v < linear) return static_cast<size_t>(v);
+      const int shift = msb(v) - (bits - 1);
+      return linear + (shift - 1) * half
+             + static_cast<size_t>((v >> shift) - half);
+    }
+
+    // the smallest and the largest value counted in bucket i
+    static Value lowest(size_t i) {
+      if (i < linear) return i;
+      const size_t shift = (i - linear) / half + 1;
+      return Value(half + (i - linear) % half) << shift;
+    }
+
+    static Value highest(size_t i) {
+      if (i < linear) return i;
+      const size_t shift = (i - linear) / half + 1;
+      return lowest(i) + (Value(1) << shift) - 1;
+    }
+
+    void record(Value v) {
+      counts[index(v)]++;
+      total++;
+      sum += v;
+      if (v < minimum) minimum = v;
+      if (v > maximum) maximum = v;
+    }
+
+    Value count() const { return total; }
+    Value count(size_t i) const { return counts[i]; }
+    Value min() const { return total ? minimum : 0; }
+    Value max() const { return maximum; }
+    double mean() const { return total ? sum / total : 0; }
+
+    // the highest value of the bucket reaching percentile of all values
+    Value percentile(double percentile) const {
+      if (!total) return 0;
+      Value rank = static_cast<Value>(percentile / 100 * total + 0.5);
+      if (rank < 1) rank = 1;
+      if (rank > total) rank = total;
+      Value seen = 0;
+      for (size_t i = 0; i < buckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return highest(i) < maximum ? highest(i) : maximum;
+      }
+      return maximum;
+    }
+
+    // "p50 1.2 us, p90 ..., max ..."
+    std::string table() const {
+      static const double percentiles[] = { 50, 90, 99, 99.9, 99.99 };
+      std::stringstream out;
+      out << "min " << duration(min());
+      for (size_t i = 0; i < sizeof(percentiles) / sizeof(double); ++i) {
+        out << ", p" << percentiles[i] << " "
+            << duration(percentile(percentiles[i]));
+      }
+      out << ", max " << duration(max()) << ", mean "
+          << duration(static_cast<Value>(mean())) << ", n " << total;
+      return out.str();
+    }
+
+    // nanoseconds in a readable unit
+    static std::string duration(Value ns) {
+      std::stringstream out;
+      out.precision(3);
+      if (ns < 1000)            out << ns << " ns";
+      else if (ns < 1000000)    out << ns / 1e3 << " us";
+      else if (ns < 1000000000) out << ns / 1e6 << " ms";
+      else                      out << ns / 1e9 << " s";
+      return out.str();
+    }
+  };
+
+  // ================================================================
+
+  // Latency Testcase
+  // ----------------
+
+  template <template <class> class WriterPolicy>
+  class LatencyTestcase : public virtual Testcase {
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    LatencyHistogram histogram;
+
+    // call callable iterations times, the budgets are std::chrono durations
+    template <class Callable, class Budget50, class Budget99>
+    Result test_latency(
+      Callable callable, size_t iterations,
+      Budget50 p50_budget, Budget99 p99_budget,
+      std::string name, const int line)
+    {
+      typedef std::chrono::steady_clock Clock;
+
+      histogram.reset();
+      callable();  // warm up
+      for (size_t i = 0; i < iterations; ++i) {
+        const Clock::time_point start = Clock::now();
+        callable();
+        const Clock::time_point end = Clock::now();
+        histogram.record(static_cast<LatencyHistogram::Value>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end - start).count()));
+      }
+
+      const LatencyHistogram::Value p50 = histogram.percentile(50);
+      const LatencyHistogram::Value p99 = histogram.percentile(99);
+      const LatencyHistogram::Value b50 = static_cast<LatencyHistogram::Value>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(p50_budget)
+          .count());
+      const LatencyHistogram::Value b99 = static_cast<LatencyHistogram::Value>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(p99_budget)
+          .count());
+
+      std::string exceeded;
+      if (p50 > b50) {
+        exceeded = format("p50 {} exceeds budget {}",
+          LatencyHistogram::duration(p50), LatencyHistogram::duration(b50));
+      }
+      if (p99 > b99) {
+        if (!exceeded.empty()) exceeded += ", ";
+        exceeded += format("p99 {} exceeds budget {}",
+          LatencyHistogram::duration(p99), LatencyHistogram::duration(b99));
+      }
+
+      if (exceeded.empty()) {
+        record_info(format("{}: {}", name, histogram.table()), line);
+        return OK;
+      }
+
+      #if ADAPTEST_BUFWRITE_FILE
+        write_histogram(name, line);
+      #endif // ADAPTEST_BUFWRITE_FILE
+
+      return Result(FAILED, name, line,
+        format("{}: {}; {}", name, exceeded, histogram.table()));
+    }
+
+    #if ADAPTEST_BUFWRITE_FILE
+    // the non empty buckets as upper bound and count columns
+    void write_histogram(const std::string& name, const int line) {
+      std::vector<double> bounds, counts;
+      for (size_t i = 0; i < LatencyHistogram::buckets; ++i) {
+        if (!histogram.count(i)) continue;
+        bounds.push_back(static_cast<double>(LatencyHistogram::highest(i)));
+        counts.push_back(static_cast<double>(histogram.count(i)));
+      }
+      if (bounds.empty()) return;
+
+      WriterPolicy<double> writer(line, *this);
+      writer.add_buf(&bounds[0], bounds.size(), format("{}-ns", name));
+      writer.add_buf(&counts[0], counts.size(), format("{}-count", name));
+      writer.write();
+    }
+    #endif // ADAPTEST_BUFWRITE_FILE
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_LATENCY_H
@@ -0,0 +1,597 @@
+#ifndef ADAPTEST_PACKED_H
+#define ADAPTEST_PACKED_H
+
+#include <adaptest.h>
+#include <adaptest/buf.h>
+
+// a compact binary format for buffer dumps and a WriterPolicy for the
+// BufferTestcase which writes it. integer buffers are delta coded using
+// zig-zag varints, floating point buffers are xor coded against their
+// predecessor (as done in facebook's gorilla). tools/unpack.cpp decodes the
+// files back to CSV. requires C++11.
+//
+// file layout, all integers varint coded:
+//   "ADPK" version count
+//   per buffer: namelen name kind size length chunks 0
+//   per chunk: chunklen payload
+// kind is 'i', 'u' or 'f', size is the size of a value in bytes. the payload
+// of a buffer is the concatenation of its chunks, so it is written while it
+// is encoded and never held in memory as a whole.
+
+#ifndef ADAPTEST_BUFWRITE_PACKED_FILENAME_FORMAT
+#define ADAPTEST_BUFWRITE_PACKED_FILENAME_FORMAT "{}-{}.adpk"
+#endif // !ADAPTEST_BUFWRITE_PACKED_FILENAME_FORMAT
+
+// number of payload bytes after which a chunk is written
+#ifndef ADAPTEST_BUFWRITE_PACKED_CHUNK
+#define ADAPTEST_BUFWRITE_PACKED_CHUNK 65536
+#endif // !ADAPTEST_BUFWRITE_PACKED_CHUNK
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <list>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Encoding Primitives
+  // -------------------
+
+  inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+  }
+
+  inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+  inline void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+      out += static_cast<char>((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+    out += static_cast<char>(v);
+  }
+
+  // returns false at the end of the stream
+  inline bool get_varint(std::istream& in, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const int c = in.get();
+      if (c == EOF) return false;
+      v |= static_cast<uint64_t>(c & 0x7f) << shift;
+      if (!(c & 0x80)) return true;
+    }
+    return false;
+  }
+
+  // write the encoded bytes as one chunk
+  inline void put_chunk(std::ostream& out, std::string& chunk) {
+    if (chunk.empty()) return;
+    std::string len;
+    put_varint(len, chunk.size());
+    out.write(len.data(), len.size());
+    out.write(chunk.data(), chunk.size());
+    chunk.clear();
+  }
+
+  // the payload of one buffer read from its chunks
+  class PackedChunkBuf : public std::streambuf {
+  private:
+    std::istream& in;
+    std::vector<char> chunk;
+    bool done;
+
+  protected:
+    virtual int_type underflow() {
+      if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+      uint64_t len;
+      if (done || !get_varint(in, len) || !len
+          || len > 64 * ADAPTEST_BUFWRITE_PACKED_CHUNK) {
+        done = true;
+        return traits_type::eof();
+      }
+      chunk.resize(static_cast<size_t>(len));
+      if (!in.read(&chunk[0], static_cast<std::streamsize>(len))) {
+        done = true;
+        return traits_type::eof();
+      }
+      setg(&chunk[0], &chunk[0], &chunk[0] + chunk.size());
+      return traits_type::to_int_type(*gptr());
+    }
+
+  public:
+    explicit PackedChunkBuf(std::istream& _in) : in(_in), done(false) {}
+  };
+
+  //--------------------------------------------------------------------------
+
+  class BitWriter {
+  private:
+    std::string& out;
+    uint64_t bits;
+    int count;
+
+  public:
+    explicit BitWriter(std::string& _out) : out(_out), bits(0), count(0) {}
+
+    // append the lowest n bits of v, msb first. n <= 64
+    void put(uint64_t v, int n) {
+      while (n > 0) {
+        const int take = n < 8 - count ? n : 8 - count;
+        const uint64_t chunk = (v >> (n - take)) & ((1u << take) - 1);
+        bits = (bits << take) | chunk;
+        count += take;
+        n -= take;
+        if (count == 8) {
+          out += static_cast<char>(bits);
+          bits = 0;
+          count = 0;
+        }
+      }
+    }
+
+    // pad the last byte with zeros
+    void flush() {
+      if (count) put(0, 8 - count);
+    }
+  };
+
+  class BitReader {
+  private:
+    std::istream& in;
+    unsigned bits;
+    int count;
+    bool truncated;
+
+  public:
+    explicit BitReader(std::istream& _in)
+    : in(_in), bits(0), count(0), truncated(false) {}
+
+    // true once bits were read past the end of the stream
+    bool eof() const { return truncated; }
+
+    uint64_t get(int n) {
+      uint64_t v = 0;
+      while (n > 0) {
+        if (!count) {
+          const int c = in.get();
+          if (c == EOF) {
+            truncated = true;
+            return 0;
+          }
+          bits = static_cast<unsigned>(c);
+          count = 8;
+        }
+        const int take = n < count ? n : count;
+        v = (v << take) | ((bits >> (count - take)) & ((1u << take) - 1));
+        count -= take;
+        n -= take;
+      }
+      return v;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // xor coding of floating point values of width bits
+  class XorEncoder {
+  private:
+    BitWriter bits;
+    const int width;
+    const int fieldbits;
+    bool first;
+    uint64_t prev;
+    int leading;
+    int trailing;
+
+    static int clz(uint64_t v, int width) {
+      int n = 0;
+      for (uint64_t mask = 1ull << (width - 1); mask && !(v & mask); mask >>= 1) n++;
+      return n;
+    }
+
+    static int ctz(uint64_t v) {
+      int n = 0;
+      for (; v && !(v & 1); v >>= 1) n++;
+      return n;
+    }
+
+  public:
+    XorEncoder(std::string& out, int _width)
+    : bits(out)
+    , width(_width)
+    , fieldbits(_width == 64 ? 6 : 5)
+    , first(true)
+    , prev(0)
+    , leading(-1)
+    , trailing(0)
+    {}
+
+    void put(uint64_t v) {
+      if (first) {
+        bits.put(v, width);
+        first = false;
+        prev = v;
+        return;
+      }
+
+      const uint64_t x = v ^ prev;
+      prev = v;
+      if (!x) {
+        bits.put(0, 1);
+        return;
+      }
+
+      int lead = clz(x, width);
+      const int trail = ctz(x);
+      if (lead > (1 << fieldbits) - 1) lead = (1 << fieldbits) - 1;
+
+      // reuse the window of the previous value if the bits fit into it
+      if (leading >= 0 && lead >= leading && trail >= trailing) {
+        bits.put(2, 2);
+        bits.put(x >> trailing, width - leading - trailing);
+        return;
+      }
+
+      const int len = width - lead - trail;
+      bits.put(3, 2);
+      bits.put(lead, fieldbits);
+      bits.put(len - 1, fieldbits);
+      bits.put(x >> trail, len);
+      leading = lead;
+      trailing = trail;
+    }
+
+    void flush() { bits.flush(); }
+  };
+
+  class XorDecoder {
+  private:
+    BitReader bits;
+    const int width;
+    const int fieldbits;
+    bool first;
+    uint64_t prev;
+    int leading;
+    int trailing;
+
+  public:
+    XorDecoder(std::istream& in, int _width)
+    : bits(in)
+    , width(_width)
+    , fieldbits(_width == 64 ? 6 : 5)
+    , first(true)
+    , prev(0)
+    , leading(0)
+    , trailing(0)
+    {}
+
+    uint64_t get() {
+      if (first) {
+        first = false;
+        return prev = bits.get(width);
+      }
+
+      if (!bits.get(1)) return prev;
+
+      if (bits.get(1)) {
+        leading = static_cast<int>(bits.get(fieldbits));
+        trailing = width - leading - static_cast<int>(bits.get(fieldbits) + 1);
+      }
+      prev ^= bits.get(width - leading - trailing) << trailing;
+      return prev;
+    }
+
+    bool eof() const { return bits.eof(); }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // the kind of encoding used for T
+  template <class T>
+  struct PackedKind {
+    static const char kind = std::is_floating_point<T>::value ? 'f'
+                            : std::is_signed<T>::value ? 'i' : 'u';
+  };
+
+  // encode buflen values of buf into chunks written to out. chunk buffers
+  // the encoded bytes in between.
+  template <class T>
+  typename std::enable_if<std::is_integral<T>::value>::type
+  pack_values(std::ostream& out, std::string& chunk, const T* buf,
+              size_t buflen)
+  {
+    uint64_t prev = 0;
+    for (size_t i = 0; i < buflen; ++i) {
+      const uint64_t v = static_cast<uint64_t>(static_cast<int64_t>(buf[i]));
+      put_varint(chunk, zigzag(static_cast<int64_t>(v - prev)));
+      prev = v;
+      if (chunk.size() >= ADAPTEST_BUFWRITE_PACKED_CHUNK) put_chunk(out, chunk);
+    }
+    put_chunk(out, chunk);
+    out.put(0);
+  }
+
+  template <class T>
+  typename std::enable_if<std::is_floating_point<T>::value>::type
+  pack_values(std::ostream& out, std::string& chunk, const T* buf,
+              size_t buflen)
+  {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+                  "only 32 and 64 bit floating point types can be packed");
+    // the encoder only appends whole bytes, so the bit stream simply
+    // continues in the next chunk
+    XorEncoder encoder(chunk, sizeof(T) * 8);
+    for (size_t i = 0; i < buflen; ++i) {
+      typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type v;
+      std::memcpy(&v, &buf[i], sizeof(T));
+      encoder.put(v);
+      if (chunk.size() >= ADAPTEST_BUFWRITE_PACKED_CHUNK) put_chunk(out, chunk);
+    }
+    encoder.flush();
+    put_chunk(out, chunk);
+    out.put(0);
+  }
+
+  // ================================================================
+
+  // Packed Buffer Writer
+  // --------------------
+
+#if ADAPTEST_BUFWRITE_FILE
+
+  template <class T>
+  class PackedBufferWriter : public BufferWriter<T> {
+    using typename BufferWriter<T>::BufferListIter;
+    using BufferWriter<T>::getTestcaseName;
+    using BufferWriter<T>::getTestsuiteName;
+    using BufferWriter<T>::error;
+    using BufferWriter<T>::getData;
+  public:
+    PackedBufferWriter(
+      const int _line, class Testcase& _testcase)
+    : BufferWriter<T>(_line, _testcase)
+    {}
+
+    virtual Result write_packed(std::ostream& file)
+    {
+      std::string header("ADPK");
+      put_varint(header, 2);
+      put_varint(header, getData().size());
+      file.write(header.data(), header.size());
+
+      std::string chunk;
+      chunk.reserve(ADAPTEST_BUFWRITE_PACKED_CHUNK + 16);
+      for (BufferListIter it = getData().begin(); it != getData().end(); ++it)
+      {
+        std::string head;
+        put_varint(head, it->name.size());
+        head += it->name;
+        head += PackedKind<T>::kind;
+        put_varint(head, sizeof(T));
+        put_varint(head, it->buflen);
+        file.write(head.data(), head.size());
+
+        pack_values(file, chunk, it->buf, it->buflen);
+      }
+
+      return OK;
+    }
+
+    Result write() {
+      string filename = format(
+        ADAPTEST_BUFWRITE_PACKED_FILENAME_FORMAT,
+        getTestsuiteName(), getTestcaseName());
+      ArtifactObservation observation(filename);
+
+      std::fstream file(filename, std::ios::out | std::ios::binary);
+      if (!file.good()) {
+        return error(format("could not open {}", filename));
+      }
+
+      Result res = write_packed(file);
+      if (res != OK) return res;
+
+      file.flush();
+      if (!file.good()) {
+        return error(format("could not write {}", filename));
+      }
+      return OK;
+    }
+  };
+
+#endif // ADAPTEST_BUFWRITE_FILE
+
+  // ================================================================
+
+  // Packed Buffer Reader
+  // --------------------
+
+  // reads the values of one buffer of a packed file, one after another
+  class PackedColumn {
+  private:
+    std::ifstream file;
+    PackedChunkBuf chunks;
+    std::istream in;
+    XorDecoder decoder;
+    uint64_t prev;
+    uint64_t remaining;
+    bool truncated;
+
+  public:
+    std::string name;
+    char kind;
+    size_t size;
+    uint64_t length;
+
+    PackedColumn(const std::string& filename, std::streamoff offset,
+                 const std::string& _name, char _kind, size_t _size,
+                 uint64_t _length)
+    : file(filename.c_str(), std::ios::in | std::ios::binary)
+    , chunks(file)
+    , in(&chunks)
+    , decoder(in, static_cast<int>(_size * 8))
+    , prev(0)
+    , remaining(_length)
+    , truncated(false)
+    , name(_name)
+    , kind(_kind)
+    , size(_size)
+    , length(_length)
+    {
+      file.seekg(offset);
+    }
+
+    // true if the payload ended before all values were decoded
+    bool eof() const { return truncated; }
+
+    // decode the next value and write it to out. false if none is left or
+    // the payload is truncated
+    bool write_next(std::ostream& out) {
+      if (!remaining || truncated) return false;
+      remaining--;
+
+      if (kind == 'f') {
+        const uint64_t bits = decoder.get();
+        if (decoder.eof()) {
+          truncated = true;
+          return false;
+        }
+        if (size == 4) {
+          float v;
+          const uint32_t b = static_cast<uint32_t>(bits);
+          std::memcpy(&v, &b, sizeof(v));
+          out << std::setprecision(9) << v;
+        } else {
+          double v;
+          std::memcpy(&v, &bits, sizeof(v));
+          out << std::setprecision(17) << v;
+        }
+        return true;
+      }
+
+      uint64_t delta;
+      if (!get_varint(in, delta)) {
+        truncated = true;
+        return false;
+      }
+      prev += static_cast<uint64_t>(unzigzag(delta));
+
+      // restore the width and signedness of the original type
+      const int shift = 64 - static_cast<int>(size * 8);
+      if (kind == 'i') {
+        out << (static_cast<int64_t>(prev << shift) >> shift);
+      } else {
+        out << ((prev << shift) >> shift);
+      }
+      return true;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  class PackedReader {
+  public:
+    typedef std::list<PackedColumn*> Columns;
+
+  private:
+    Columns columns;
+
+    PackedReader(const PackedReader&);
+    PackedReader& operator = (const PackedReader&);
+
+  public:
+    PackedReader() {}
+
+    ~PackedReader() {
+      for (Columns::iterator i = columns.begin(); i != columns.end(); ++i) {
+        delete *i;
+      }
+    }
+
+    Columns& getColumns() { return columns; }
+
+    // read the header of all buffers. returns an error message or ""
+    std::string open(const std::string& filename) {
+      std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!in.good()) return "could not open " + filename;
+
+      char magic[4];
+      uint64_t version, count;
+      if (!in.read(magic, 4) || std::memcmp(magic, "ADPK", 4) != 0
+          || !get_varint(in, version) || version != 2
+          || !get_varint(in, count)) {
+        return filename + " is not a packed buffer file";
+      }
+
+      for (uint64_t i = 0; i < count; ++i) {
+        uint64_t namelen, size, length;
+        if (!get_varint(in, namelen)) return filename + " is truncated";
+        std::string name(static_cast<size_t>(namelen), '\0');
+        in.read(&name[0], static_cast<std::streamsize>(namelen));
+        const int kind = in.get();
+        if (!in.good() || !get_varint(in, size) || !get_varint(in, length)) {
+          return filename + " is truncated";
+        }
+        if ((kind != 'i' && kind != 'u' && kind != 'f') || !size || size > 8
+            || (kind == 'f' && size != 4 && size != 8)) {
+          return filename + " contains an unknown buffer type";
+        }
+
+        columns.push_back(new PackedColumn(filename, in.tellg(), name,
+          static_cast<char>(kind), static_cast<size_t>(size), length));
+
+        // skip the chunks up to the terminating empty one
+        uint64_t chunk;
+        do {
+          if (!get_varint(in, chunk)) return filename + " is truncated";
+          in.seekg(static_cast<std::streamoff>(chunk), std::ios::cur);
+        } while (chunk);
+      }
+
+      return "";
+    }
+
+    // write all buffers columnwise as CSV like CSVBufferWriter does, preceded
+    // by a commented line of buffer names. returns an error message or ""
+    std::string write_csv(std::ostream& csv) {
+      csv << "# ";
+      for (Columns::iterator i = columns.begin(); i != columns.end(); ++i) {
+        if (i != columns.begin()) csv << ",";
+        csv << (*i)->name;
+      }
+      csv << "\n";
+
+      for (bool more = true; more; ) {
+        more = false;
+        std::string row;
+        for (Columns::iterator i = columns.begin(); i != columns.end(); ++i) {
+          std::stringstream value;
+          if ((*i)->write_next(value)) more = true;
+          if (i != columns.begin()) row += ",";
+          row += value.str();
+        }
+        if (more) csv << row << "\n";
+      }
+
+      for (Columns::iterator i = columns.begin(); i != columns.end(); ++i) {
+        if ((*i)->eof()) return "buffer " + (*i)->name + " is truncated";
+      }
+      return "";
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_PACKED_H
@@ -0,0 +1,387 @@
+#ifndef ADAPTEST_PARAM_H
+#define ADAPTEST_PARAM_H
+
+#include <adaptest.h>
+
+// parameterized testcases for Adaptest. the body of a TESTCASE_P() is run
+// once per row of a parameter table, the current row is named param. every
+// row is logged as a testcase of its own named "name[row]" and the rows are
+// spread over the threads given by --jobs. tables are
+//   param_array(rows)     a static array of any row type
+//   CsvTable(filename)    a memory mapped CSV file, rows are CsvRows
+//   BinaryTable<T>(filename)  a memory mapped file of packed T records
+// the files are mapped when the testcase is run first, a row is parsed when
+// it is run. requires C++11 and POSIX.
+//
+//   struct AddCase { int a, b, sum; };
+//   static const AddCase addCases[] = { {1, 2, 3}, {2, 2, 4} };
+//
+//   TESTSUITE(MySuite, AdapTest::Testcase, "")
+//     TESTCASE_P(add, "", AdapTest::param_array(addCases))
+//       TEST(eq, param.sum, param.a + param.b, "sum")
+//     END_TESTCASE()
+//   END_TESTSUITE()
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Parameter Tables
+  // ----------------
+
+  // a table has a Row type, size(), get(row) and error(). get() has to be
+  // thread safe once size() was called.
+
+  template <class T>
+  class ArrayTable {
+  private:
+    const T* rows;
+    size_t count;
+
+  public:
+    typedef T Row;
+
+    ArrayTable(const T* _rows, size_t _count)
+    : rows(_rows)
+    , count(_count)
+    {}
+
+    size_t size() { return count; }
+    const Row& get(size_t row) { return rows[row]; }
+    std::string error() { return ""; }
+  };
+
+  template <class T, size_t N>
+  ArrayTable<T> param_array(const T (&rows)[N]) {
+    return ArrayTable<T>(rows, N);
+  }
+
+  //--------------------------------------------------------------------------
+
+  // a read only memory mapping of a whole file, shared by all copies of a
+  // table and mapped upon first use
+  class MappedFile {
+  private:
+    std::string filename;
+    std::once_flag once;
+    const char* data;
+    size_t length;
+    std::string failure;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator = (const MappedFile&);
+
+    void map() {
+      const int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0) {
+        failure = format("could not open {}", filename);
+        return;
+      }
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* mem = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mem == MAP_FAILED) {
+          failure = format("could not map {}", filename);
+        } else {
+          data = static_cast<const char*>(mem);
+          length = st.st_size;
+        }
+      }
+      ::close(fd);
+    }
+
+  public:
+    explicit MappedFile(const std::string& _filename)
+    : filename(_filename)
+    , data(0)
+    , length(0)
+    {}
+
+    ~MappedFile() {
+      if (data) munmap(const_cast<char*>(data), length);
+    }
+
+    // map the file if not done yet, false upon errors
+    bool open() {
+      std::call_once(once, &MappedFile::map, this);
+      return failure.empty();
+    }
+
+    const char* begin() const { return data; }
+    const char* end() const { return data + length; }
+    size_t size() const { return length; }
+    const std::string& error() const { return failure; }
+    const std::string& name() const { return filename; }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // a file of packed T records as written by fwrite(records, sizeof(T), n)
+  template <class T>
+  class BinaryTable {
+  private:
+    std::shared_ptr<MappedFile> file;
+
+  public:
+    typedef T Row;
+
+    explicit BinaryTable(const std::string& filename)
+    : file(new MappedFile(filename))
+    {}
+
+    size_t size() {
+      if (!file->open() || file->size() % sizeof(T)) return 0;
+      return file->size() / sizeof(T);
+    }
+
+    Row get(size_t row) {
+      Row value;
+      std::memcpy(&value, file->begin() + row * sizeof(T), sizeof(T));
+      return value;
+    }
+
+    std::string error() {
+      if (!file->open()) return file->error();
+      if (file->size() % sizeof(T)) {
+        return format("size of {} is no multiple of {}",
+                      file->name(), sizeof(T));
+      }
+      return "";
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // one row of a CsvTable
+  class CsvRow {
+  public:
+    typedef std::map<std::string, size_t> Columns;
+
+  private:
+    std::vector<std::string> fields;
+    const Columns* columns;
+    static const std::string& empty() {
+      static const std::string value;
+      return value;
+    }
+
+  public:
+    CsvRow() : columns(0) {}
+
+    // parse the fields of one line, "quoted" fields may contain commas
+    CsvRow(const char* begin, const char* end, const Columns* _columns)
+    : columns(_columns)
+    {
+      std::string field;
+      bool quoted = false;
+      for (const char* c = begin; c != end; ++c) {
+        if (quoted) {
+          if (*c != '"')                   field += *c;
+          else if (c + 1 != end && c[1] == '"') field += *c++;
+          else                             quoted = false;
+        } else if (*c == '"') {
+          quoted = true;
+        } else if (*c == ',') {
+          fields.push_back(field);
+          field.clear();
+        } else if (*c != '\r') {
+          field += *c;
+        }
+      }
+      fields.push_back(field);
+    }
+
+    size_t size() const { return fields.size(); }
+
+    // missing fields are empty
+    const std::string& operator [] (size_t column) const {
+      return column < fields.size() ? fields[column] : empty();
+    }
+
+    // by the name given in the header line
+    const std::string& operator [] (const std::string& column) const {
+      if (!columns) return empty();
+      Columns::const_iterator i = columns->find(column);
+      return i == columns->end() ? empty() : (*this)[i->second];
+    }
+
+    template <class Column>
+    double number(const Column& column) const {
+      return std::strtod((*this)[column].c_str(), 0);
+    }
+
+    template <class Column>
+    long integer(const Column& column) const {
+      return std::strtol((*this)[column].c_str(), 0, 0);
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // a CSV file, one row per line. empty lines and lines starting with '#'
+  // are skipped. with header the first line names the columns.
+  class CsvTable {
+  private:
+    struct Index {
+      std::once_flag once;
+      std::vector<const char*> lines;  // begin of every row and one past
+      CsvRow::Columns columns;
+    };
+
+    std::shared_ptr<MappedFile> file;
+    std::shared_ptr<Index> index;
+    bool header;
+
+    void build() {
+      if (!file->open()) return;
+
+      bool first = true;
+      const char* end = file->end();
+      for (const char* line = file->begin(); line && line < end; ) {
+        const char* eol = static_cast<const char*>(
+          std::memchr(line, '\n', end - line));
+        const char* next = eol ? eol + 1 : end;
+        if (line != next && *line != '#' && *line != '\n' && *line != '\r') {
+          if (first && header) {
+            CsvRow names(line, eol ? eol : end, 0);
+            for (size_t i = 0; i < names.size(); ++i) {
+              index->columns[names[i]] = i;
+            }
+          } else {
+            index->lines.push_back(line);
+          }
+          first = false;
+        }
+        line = next;
+      }
+    }
+
+  public:
+    typedef CsvRow Row;
+
+    explicit CsvTable(const std::string& filename, bool _header = false)
+    : file(new MappedFile(filename))
+    , index(new Index())
+    , header(_header)
+    {}
+
+    // indexes the lines upon first use
+    size_t size() {
+      std::call_once(index->once, &CsvTable::build, this);
+      return index->lines.size();
+    }
+
+    Row get(size_t row) {
+      const char* begin = index->lines[row];
+      const char* eol = static_cast<const char*>(
+        std::memchr(begin, '\n', file->end() - begin));
+      return CsvRow(begin, eol ? eol : file->end(), &index->columns);
+    }
+
+    std::string error() { return file->open() ? "" : file->error(); }
+  };
+
+  // ================================================================
+
+  // Parameter Row
+  // -------------
+
+  // the row a parameterized testcase instance runs with
+  template <class Table>
+  class ParamCursor {
+  public:
+    typedef typename Table::Row Row;
+
+  private:
+    bool selected;
+    std::string rowName;
+    Row value;
+
+  public:
+    ParamCursor() : selected(false), value() {}
+
+    bool isRow() const { return selected; }
+
+    void select(Table& table, const std::string& name, size_t row) {
+      selected = true;
+      rowName = format("{}[{}]", name, row);
+      value = table.get(row);
+    }
+
+    std::string& getName(std::string& name) {
+      return selected ? rowName : name;
+    }
+
+    const Row& param() const { return value; }
+
+    // the result of a testcase whose table has no rows
+    static Result unexpanded(Table& table) {
+      const std::string msg = table.error();
+      if (!msg.empty()) return Result(ERROR, "", 0, msg);
+      return OK;
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+// Define a parameterized Testcase
+// -------------------------------
+
+// the body is run with "const Row& param" for every row of _table and ends
+// with END_TESTCASE()
+#if ADAPTEST_AUTONAMES == 1
+#define TESTCASE_P(_desc, _table)                                              \
+  TESTCASE_P__( TONICTEST_NAME( testcase_ ), _desc, _table )
+#define TESTCASE_P__(_name, _desc, _table) TESTCASE_P_(_name, _desc, _table)
+#else
+#define TESTCASE_P(_name, _desc, _table) TESTCASE_P_(_name, _desc, _table)
+#endif
+
+#define TESTCASE_P_(_name, _desc, _table)                                      \
+  class _name;                                                                 \
+  TestcaseRegistration<_name, __LINE__> _name##Reg;                            \
+  class _name : public LocalTestcase {                                         \
+    typedef decltype(_table) ParamTable;                                       \
+    typedef ADAPTEST_NAMESPACE::ParamCursor<ParamTable> Cursor;                \
+    std::string name;                                                          \
+    std::string desc;                                                          \
+    Cursor cursor;                                                             \
+    static ParamTable& getTable() {                                            \
+      static ParamTable table = _table;                                        \
+      return table;                                                            \
+    }                                                                          \
+    public:                                                                    \
+    _name() : name(#_name), desc(_desc) {}                                     \
+    virtual std::string& getName() { return cursor.getName(name); }            \
+    virtual std::string& getDesc() { return desc; }                            \
+    virtual ADAPTEST_NAMESPACE::Testcase* newInstance() {                      \
+      _name* instance = new _name();                                           \
+      instance->cursor = cursor;                                               \
+      return instance;                                                         \
+    }                                                                          \
+    virtual size_t getRows() {                                                 \
+      return cursor.isRow() ? 0 : getTable().size();                           \
+    }                                                                          \
+    virtual ADAPTEST_NAMESPACE::Testcase* newRow(size_t row) {                 \
+      _name* instance = new _name();                                           \
+      instance->cursor.select(getTable(), name, row);                          \
+      return instance;                                                         \
+    }                                                                          \
+    virtual ADAPTEST_NAMESPACE::Result run() {                                 \
+      if (!cursor.isRow()) return Cursor::unexpanded(getTable());              \
+      return run_param(cursor.param());                                        \
+    }                                                                          \
+    ADAPTEST_NAMESPACE::Result run_param(const Cursor::Row& param) {           \
+
+#endif //ADAPTEST_PARAM_H
@@ -0,0 +1,300 @@
+#ifndef ADAPTEST_PROFILE_H
+#define ADAPTEST_PROFILE_H
+
+#include <adaptest.h>
+#include <adaptest/runner.h>
+
+// a sampling profiler for Adaptest. including this header into any
+// translation unit of a test binary samples the stacks of all threads during
+// the run() of every testcase and writes them as folded stacks, one file per
+// testcase, ready for flamegraph.pl or speedscope. the SIGPROF handler only
+// stores the return addresses into a preallocated buffer, they are
+// symbolized after the run. testcases which run while another one is being
+// profiled (--jobs, --repeat-parallel) are not profiled. link with -rdynamic
+// to get the names of the functions of the test binary. requires C++11 and
+// glibc.
+
+// samples per second of cpu time
+#ifndef ADAPTEST_PROFILE_HZ
+#define ADAPTEST_PROFILE_HZ 997
+#endif // !ADAPTEST_PROFILE_HZ
+
+// maximal number of samples per testcase, later samples are dropped
+#ifndef ADAPTEST_PROFILE_SAMPLES
+#define ADAPTEST_PROFILE_SAMPLES 16384
+#endif // !ADAPTEST_PROFILE_SAMPLES
+
+// maximal number of frames per sample
+#ifndef ADAPTEST_PROFILE_DEPTH
+#define ADAPTEST_PROFILE_DEPTH 64
+#endif // !ADAPTEST_PROFILE_DEPTH
+
+// arguments are testsuite and testcase
+#ifndef ADAPTEST_PROFILE_FILENAME_FORMAT
+#define ADAPTEST_PROFILE_FILENAME_FORMAT "{}-{}.folded"
+#endif // !ADAPTEST_PROFILE_FILENAME_FORMAT
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // the samples of one testcase. written by the signal handler, read after
+  // the timer was stopped and all handlers returned.
+  class ProfileBuffer {
+  public:
+    struct Sample {
+      // set once depth and frames are written
+      std::atomic<bool> committed;
+      int depth;
+      void* frames[ADAPTEST_PROFILE_DEPTH];
+    };
+
+  private:
+    Sample samples[ADAPTEST_PROFILE_SAMPLES];
+    std::atomic<size_t> next;
+
+    void clear(size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        samples[i].committed.store(false, std::memory_order_relaxed);
+        samples[i].depth = 0;
+      }
+    }
+
+  public:
+    ProfileBuffer() : next(0) { clear(ADAPTEST_PROFILE_SAMPLES); }
+
+    void reset() {
+      clear(size());
+      next.store(0);
+    }
+
+    // async signal safe, claims a slot without locking. 0 if full.
+    Sample* claim() {
+      const size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+      return slot < ADAPTEST_PROFILE_SAMPLES ? &samples[slot] : 0;
+    }
+
+    size_t size() const {
+      const size_t n = next.load();
+      return n < ADAPTEST_PROFILE_SAMPLES ? n : ADAPTEST_PROFILE_SAMPLES;
+    }
+
+    size_t dropped() const { return next.load() - size(); }
+
+    const Sample& operator [] (size_t i) const { return samples[i]; }
+  };
+
+  //--------------------------------------------------------------------------
+
+  class SamplingProfiler : public RunObserver, public RunFinalizer {
+  private:
+    typedef std::map<void*, std::string> Symbols;
+    typedef std::map<std::string, size_t> Folded;
+
+    ProfileBuffer* buffer;
+    std::atomic<int> running;
+    std::atomic<Testcase*> profiled;
+    std::mutex mutex;
+    std::list<Result> errors;
+    Symbols symbols;
+
+    static std::atomic<ProfileBuffer*>& activeBuffer() {
+      static std::atomic<ProfileBuffer*> active(0);
+      return active;
+    }
+
+    // handlers which may still write to the active buffer
+    static std::atomic<int>& handlersRunning() {
+      static std::atomic<int> count(0);
+      return count;
+    }
+
+    // SIGPROF is sent to the whole process, so with --jobs a handler may run
+    // on any thread, even while stop() is called
+    static void handler(int) {
+      const int saved = errno;
+      handlersRunning().fetch_add(1);
+      ProfileBuffer* active = activeBuffer().load();
+      ProfileBuffer::Sample* sample = active ? active->claim() : 0;
+      if (sample) {
+        // called right here, so the handler is always the first frame
+        sample->depth = backtrace(sample->frames, ADAPTEST_PROFILE_DEPTH);
+        sample->committed.store(true, std::memory_order_release);
+      }
+      handlersRunning().fetch_sub(1);
+      errno = saved;
+    }
+
+    SamplingProfiler()
+    : buffer(0)
+    , running(0)
+    , profiled(0)
+    {
+      TestsuiteRegistration::addObserver(this);
+      TestsuiteRegistration::addFinalizer(this);
+    }
+
+    void start() {
+      if (!buffer) {
+        buffer = new ProfileBuffer();
+
+        // the first backtrace() loads libgcc, which must not happen in the
+        // signal handler
+        void* warmup[1];
+        backtrace(warmup, 1);
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &SamplingProfiler::handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, 0);
+      }
+      buffer->reset();
+      activeBuffer().store(buffer, std::memory_order_release);
+      set_timer(1000000 / ADAPTEST_PROFILE_HZ);
+    }
+
+    // a handler which did not see the cleared buffer has already counted
+    // itself as running
+    void stop() {
+      set_timer(0);
+      activeBuffer().store(0);
+      while (handlersRunning().load()) std::this_thread::yield();
+    }
+
+    static void set_timer(long usec) {
+      struct itimerval timer;
+      timer.it_interval.tv_sec = 0;
+      timer.it_interval.tv_usec = usec;
+      timer.it_value = timer.it_interval;
+      setitimer(ITIMER_PROF, &timer, 0);
+    }
+
+    const std::string& symbolize(void* address) {
+      Symbols::iterator known = symbols.find(address);
+      if (known != symbols.end()) return known->second;
+
+      std::string name;
+      Dl_info info;
+      // return addresses point behind the call
+      void* call = static_cast<char*>(address) - 1;
+      if (dladdr(call, &info) && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+        name = status == 0 && demangled ? demangled : info.dli_sname;
+        std::free(demangled);
+      } else if (dladdr(call, &info) && info.dli_fname) {
+        // resolvable by addr2line
+        const char* file = std::strrchr(info.dli_fname, '/');
+        std::stringstream offset;
+        offset << std::hex << "0x"
+               << (static_cast<char*>(call)
+                   - static_cast<char*>(info.dli_fbase));
+        name = format("{}+{}", file ? file + 1 : info.dli_fname,
+                      offset.str());
+      } else {
+        name = format("{}", call);
+      }
+      // ';' separates the frames
+      for (size_t i = 0; i < name.size(); ++i) {
+        if (name[i] == ';') name[i] = ',';
+      }
+      return symbols[address] = name;
+    }
+
+    // testcases which ran too short for a sample get no file
+    void write(Testcase& test) {
+      if (!buffer->size() && !buffer->dropped()) return;
+
+      // the first two frames are the handler and the signal trampoline
+      const int skip = 2;
+      Folded folded;
+      for (size_t s = 0; s < buffer->size(); ++s) {
+        const ProfileBuffer::Sample& sample = (*buffer)[s];
+        if (!sample.committed.load(std::memory_order_acquire)) continue;
+        std::string stack;
+        for (int f = sample.depth - 1; f >= skip; --f) {
+          if (!stack.empty()) stack += ';';
+          stack += symbolize(sample.frames[f]);
+        }
+        if (!stack.empty()) folded[stack]++;
+      }
+      if (buffer->dropped()) {
+        folded[format("[{} dropped samples]", buffer->dropped())] +=
+          buffer->dropped();
+      }
+
+      const std::string filename = format(ADAPTEST_PROFILE_FILENAME_FORMAT,
+        test.getTestsuite().getName(), test.getName());
+      std::ofstream file(filename.c_str());
+      for (Folded::iterator i = folded.begin(); i != folded.end(); ++i) {
+        file << i->first << " " << i->second << "\n";
+      }
+      if (!file.good()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        errors.push_back(Result(ERROR, test.getName(), 0,
+          format("could not write {}", filename)));
+      }
+    }
+
+  public:
+    static SamplingProfiler& instance() {
+      static SamplingProfiler profiler;
+      return profiler;
+    }
+
+    virtual void phase_start(Testcase& test, Phase phase) {
+      if (phase != RUN) return;
+      if (running.fetch_add(1) == 0) {
+        profiled.store(&test);
+        start();
+      }
+    }
+
+    virtual void phase_done(Testcase& test, Phase phase) {
+      if (phase != RUN) return;
+      if (profiled.load() == &test) {
+        stop();
+        profiled.store(0);
+        write(test);
+      }
+      running.fetch_sub(1);
+    }
+
+    // report the files which could not be written
+    virtual void finish(Logger& logger) {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (std::list<Result>::iterator i = errors.begin();
+           i != errors.end(); ++i)
+      {
+        logger.artifact_error(*i);
+      }
+      errors.clear();
+    }
+  };
+
+  // registers the profiler by including this header
+  static struct ProfileRegistration {
+    ProfileRegistration() { SamplingProfiler::instance(); }
+  } profileRegistration;
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_PROFILE_H
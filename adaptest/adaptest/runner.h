@@ -0,0 +1,926 @@
+#ifndef ADAPTEST_RUNNER_H
+#define ADAPTEST_RUNNER_H
+
+#include <adaptest.h>
+
+// the runner of Adaptest: the command line options, the testsuite registry
+// and the definitions of everything adaptest.h only declares. adaptest.h
+// includes it, except into the testsuites of the build throughput mode
+// (ADAPTEST_LEAN), where only adaptest/runner.cpp compiles the definitions.
+// headers which register observers or finalizers include it themselves.
+
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <cstdio>
+#include <cstdlib>
+
+#if ADAPTEST_RUNNER_DEFINITIONS
+#if ADAPTEST_DEFAULT_LOGGER
+#include <iostream>
+#include <iomanip>
+#endif
+#include <cmath>
+#include <ctime>
+
+#if ADAPTEST_THREADS
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif // ADAPTEST_THREADS
+#endif // ADAPTEST_RUNNER_DEFINITIONS
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Command Line Options
+  // --------------------
+
+  struct RunOptions {
+    // run only these testsuites and testcases, all if empty
+    std::list<std::string> suites;
+    std::list<std::string> testcases;
+    // only print the names of the testsuites
+    bool list;
+    // run every testcase this many times, 0 means until it fails
+    size_t repeat;
+    // stop repeating a testcase after its first failure
+    bool until_fail;
+    // number of threads which share the repetitions or the parameter rows
+    // of a testcase
+    size_t jobs;
+    // serve run requests on this unix socket instead of running once
+    std::string serve;
+
+    RunOptions() 
+    : list(false)
+    , repeat(1)
+    , until_fail(false)
+    , jobs(1)
+    {}
+
+    bool repeating() const { return repeat != 1 || until_fail; }
+
+    static bool contains(
+      const std::list<std::string>& names, const std::string& name)
+    {
+      if (names.empty()) return true;
+      for (std::list<std::string>::const_iterator i = names.begin(); 
+           i != names.end(); ++i)
+      {
+        if (*i == name) return true;
+      }
+      return false;
+    }
+
+    bool suite_selected(const std::string& name) const {
+      return contains(suites, name);
+    }
+
+    bool testcase_selected(const std::string& name) const {
+      return contains(testcases, name);
+    }
+
+    // true if single rows "name[row]" of a parameterized testcase are selected
+    bool rows_selected(const std::string& name) const {
+      const std::string prefix = name + "[";
+      for (std::list<std::string>::const_iterator i = testcases.begin(); 
+           i != testcases.end(); ++i)
+      {
+        if (i->compare(0, prefix.size(), prefix) == 0) return true;
+      }
+      return false;
+    }
+  };
+
+  #if ADAPTEST_RUNNER_DEFINITIONS
+
+  // returns false upon unknown arguments
+  ADAPTEST_RUNNER_INLINE
+  bool parse_options(int argc, char const *argv[], RunOptions& options)
+  {
+    bool repeat_given = false;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg(argv[i]);
+      if (arg == "--list") {
+        options.list = true;
+      } else if (arg == "--suite" && i + 1 < argc) {
+        options.suites.push_back(argv[++i]);
+      } else if (arg == "--testcase" && i + 1 < argc) {
+        options.testcases.push_back(argv[++i]);
+      } else if (arg == "--repeat" && i + 1 < argc) {
+        options.repeat = std::strtoul(argv[++i], 0, 10);
+        if (!options.repeat) return false;
+        repeat_given = true;
+      } else if (arg == "--serve" && i + 1 < argc) {
+        options.serve = argv[++i];
+      } else if (arg == "--until-fail") {
+        options.until_fail = true;
+      } else if (arg == "--repeat-parallel" || arg == "--jobs") {
+        options.jobs = 0;
+        if (i + 1 < argc && argv[i + 1][0] != '-') {
+          options.jobs = std::strtoul(argv[++i], 0, 10);
+        }
+        #if ADAPTEST_THREADS
+        if (!options.jobs) options.jobs = std::thread::hardware_concurrency();
+        #endif
+        if (!options.jobs) options.jobs = 1;
+      } else {
+        return false;
+      }
+    }
+    if (options.until_fail && !repeat_given) options.repeat = 0;
+    return true;
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void print_usage(const char* argv0)
+  {
+    std::fprintf(stderr,
+      "usage: %s [options]\n"
+      "  --list                 print the names of all testsuites\n"
+      "  --suite <name>         run only this testsuite, may be repeated\n"
+      "  --testcase <name>      run only this testcase, may be repeated\n"
+      "  --repeat <n>           run every testcase n times\n"
+      "  --until-fail           repeat every testcase until it fails\n"
+      "  --repeat-parallel [n]  spread the repetitions over n threads\n"
+      "  --jobs [n]             run parameter rows and repetitions on n threads\n"
+      "  --serve <socket>       keep running and serve run requests\n",
+      argv0);
+  }
+
+  #else
+
+  bool parse_options(int argc, char const *argv[], RunOptions& options);
+  void print_usage(const char* argv0);
+
+  #endif // ADAPTEST_RUNNER_DEFINITIONS
+
+  // ================================================================
+
+  // the testcase registration list
+  class Testcases : public std::map<int, Testcase*> {};
+
+  typedef std::list<RunObserver*> RunObservers;
+
+  inline RunObservers& runObservers() {
+    static RunObservers list;
+    return list;
+  }
+
+  // ------------------------------------------------------------------------
+
+  // Testsuite Auto registration
+  // ---------------------------
+
+  typedef std::list<TestsuiteBase*> Testsuites;
+
+  // all globals are function-local statics of inline functions, so any
+  // number of translation units may include this header and register their
+  // testsuites into the same executable.
+
+  // the logger of the current run
+  inline Logger*& currentLogger() {
+    static Logger* logger = 0;
+    return logger;
+  }
+
+  // called after all testsuites were run, p.e. to flush pending output
+  class RunFinalizer {
+  public:
+    virtual void finish(Logger& logger) = 0;
+    virtual ~RunFinalizer() {}
+  };
+
+  typedef std::list<RunFinalizer*> RunFinalizers;
+
+  // runs the testsuites upon requests instead of once, see adaptest/serve.h
+  class RunServer {
+  public:
+    virtual int serve(const RunOptions& options) = 0;
+    virtual ~RunServer() {}
+  };
+
+  // ------------------------------------------------------------------------
+
+  class TestsuiteRegistration {
+  public:
+    static Testsuites& testsuites() {
+      static Testsuites list;
+      return list;
+    }
+
+    static RunFinalizers& finalizers() {
+      static RunFinalizers list;
+      return list;
+    }
+
+    static void addFinalizer(RunFinalizer* finalizer) {
+      finalizers().push_back(finalizer);
+    }
+
+    // observers have to be added before the run
+    static void addObserver(RunObserver* observer) {
+      runObservers().push_back(observer);
+    }
+
+    static void removeObserver(RunObserver* observer) {
+      runObservers().remove(observer);
+    }
+
+    static RunServer*& server() {
+      static RunServer* instance = 0;
+      return instance;
+    }
+
+    // run the server registered by including adaptest/serve.h
+    static int serve(const RunOptions& options) {
+      if (!server()) {
+        std::fprintf(stderr, "--serve requires adaptest/serve.h\n");
+        return 2;
+      }
+      return server()->serve(options);
+    }
+
+    // constructor which in fact registers the testsuite
+    static void add(TestsuiteBase* testsuite) {
+      testsuites().push_back(testsuite);
+    }
+
+    // print the names of all testsuites
+    static int list() {
+      for (Testsuites::iterator i = testsuites().begin(); 
+           i != testsuites().end(); ++i)
+      {
+        std::printf("%s\n", (*i)->getName().c_str());
+      }
+      return 0;
+    }
+
+    static int run(Logger& logger, const RunOptions& options = RunOptions()) {
+      if (testsuites().empty()) return -1;
+
+      currentLogger() = &logger;
+      for (Testsuites::iterator i = testsuites().begin(); 
+           i != testsuites().end(); ++i)
+      {
+        if (options.suite_selected((*i)->getName())) (*i)->run(logger, options);
+      }
+
+      for (RunFinalizers::iterator i = finalizers().begin();
+           i != finalizers().end(); ++i)
+      {
+        (*i)->finish(logger);
+      }
+
+      currentLogger() = 0;
+      return logger.getFailed();
+    }
+  };
+
+  // Main entrance Functions
+  // -----------------------
+
+  inline
+  int run(Logger& logger) {
+    return TestsuiteRegistration::run(logger);
+  }
+
+  inline
+  int run(Logger& logger, const RunOptions& options) {
+    return TestsuiteRegistration::run(logger, options);
+  }
+
+
+  // ========================================================================
+
+  #if ADAPTEST_RUNNER_DEFINITIONS
+
+  // Simple String Formatter
+  // -----------------------
+
+  ADAPTEST_RUNNER_INLINE
+  void write_cstring(std::ostream& out, const void* value)
+  { out << static_cast<const char*>(value); }
+
+  ADAPTEST_RUNNER_INLINE
+  string format_args(const string& fmt, const FormatArg* args, size_t count)
+  {
+    stringstream output;
+    size_t offset = 0;
+    size_t param  = -1;
+    size_t find   = 0;
+    while ((find = fmt.find('{', offset)) != string::npos) {
+        output << fmt.substr(offset, find - offset);
+        offset = find + 1;
+        char selection = fmt[offset];
+        if ((selection >= '0') && (selection < '5')) {
+            offset++;
+            param = (size_t) selection - '0';
+        } else if (selection == '}') {
+            param++;
+        } else {
+            offset = fmt.find('}', offset) + 1;
+            continue;
+        }
+        if (param < count) args[param].write(output);
+        offset++;
+    }
+    output << fmt.substr(offset, fmt.length() - offset);
+    return output.str();
+  }
+
+  #if ADAPTEST_LEAN
+  #define ADAPTEST_INSTANCE(T)                                                 \
+    template <> void write_value<T>(std::ostream& out, const void* value)      \
+    { out << *static_cast<const T*>(value); }
+  ADAPTEST_INSTANCE_TYPES(ADAPTEST_INSTANCE)
+  #undef ADAPTEST_INSTANCE
+  #endif // ADAPTEST_LEAN
+
+  // ================================================================
+
+  // Run Observers
+  // -------------
+
+  ADAPTEST_RUNNER_INLINE
+  ArtifactObservation::ArtifactObservation(const std::string& _name)
+  : name(_name)
+  {
+    RunObservers& observers = runObservers();
+    for (RunObservers::iterator i = observers.begin(); 
+         i != observers.end(); ++i)
+    {
+      (*i)->artifact_start(name);
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  ArtifactObservation::~ArtifactObservation()
+  {
+    RunObservers& observers = runObservers();
+    for (RunObservers::reverse_iterator i = observers.rbegin(); 
+         i != observers.rend(); ++i)
+    {
+      (*i)->artifact_done(name);
+    }
+  }
+
+  // ================================================================
+
+  // Repetition Statistics
+  // ---------------------
+
+  // seconds since an arbitrary point in time
+  inline double now_seconds() {
+    #if ADAPTEST_THREADS
+      return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    #else
+      return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    #endif
+  }
+
+  // the outcome of all repetitions of a testcase
+  class RepeatStats {
+  public:
+    struct Signature {
+      size_t count;
+      Result example;
+      Signature(const Result& res) : count(0), example(res) {}
+    };
+
+    typedef std::map<std::string, Signature> Signatures;
+
+    size_t runs;
+    size_t failures;
+    ResultEnum worst;
+    Signatures signatures;
+    // running mean and sum of squared deviations of the runtime (Welford)
+    double mean;
+    double m2;
+
+    RepeatStats() : runs(0), failures(0), worst(OK), mean(0), m2(0) {}
+
+    void add(const Result& res, double seconds) {
+      runs++;
+      const double delta = seconds - mean;
+      mean += delta / runs;
+      m2 += delta * (seconds - mean);
+
+      if (res.resval == OK) return;
+      failures++;
+      if (res.resval == ERROR || worst == OK) worst = res.resval;
+
+      // failures of the same test at the same line count as one signature
+      const std::string key = format("line {}: {}", res.line, 
+                                     res.test.empty() ? res.msg : res.test);
+      Signatures::iterator i = signatures.find(key);
+      if (i == signatures.end()) {
+        i = signatures.insert(std::make_pair(key, Signature(res))).first;
+      }
+      i->second.count++;
+    }
+
+    void merge(const RepeatStats& o) {
+      if (!o.runs) return;
+      const double delta = o.mean - mean;
+      const size_t total = runs + o.runs;
+      m2 += o.m2 + delta * delta * runs * o.runs / total;
+      mean += delta * o.runs / total;
+      runs = total;
+      failures += o.failures;
+      if (o.worst == ERROR || worst == OK) worst = o.worst;
+      for (Signatures::const_iterator i = o.signatures.begin(); 
+           i != o.signatures.end(); ++i)
+      {
+        Signatures::iterator mine = signatures.find(i->first);
+        if (mine == signatures.end()) {
+          signatures.insert(*i);
+        } else {
+          mine->second.count += i->second.count;
+        }
+      }
+    }
+
+    double stddev() const {
+      return runs > 1 ? std::sqrt(m2 / (runs - 1)) : 0;
+    }
+
+    string summary() const {
+      stringstream out;
+      out << (runs - failures) << " of " << runs << " runs passed ("
+          << (runs ? 100.0 * (runs - failures) / runs : 0.0) << "%), "
+          << mean * 1000 << " ms +- " << stddev() * 1000 << " ms";
+      return out.str();
+    }
+
+    // the failure signature histogram
+    string histogram() const {
+      stringstream out;
+      for (Signatures::const_iterator i = signatures.begin(); 
+           i != signatures.end(); ++i)
+      {
+        if (i != signatures.begin()) out << "; ";
+        out << i->second.count << "x " << i->first 
+            << " (" << i->second.example.msg << ")";
+      }
+      return out.str();
+    }
+  };
+
+  #if ADAPTEST_THREADS
+  // guards the counters shared by the threads running one testcase
+  inline std::mutex& repeat_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+  #endif
+
+  // ================================================================
+
+  // Test Suite
+  // ----------
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::phase_start(Testcase& test, Phase phase)
+  {
+    RunObservers& observers = runObservers();
+    for (RunObservers::iterator i = observers.begin(); 
+         i != observers.end(); ++i)
+    {
+      (*i)->phase_start(test, phase);
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::phase_done(Testcase& test, Phase phase)
+  {
+    RunObservers& observers = runObservers();
+    for (RunObservers::reverse_iterator i = observers.rbegin(); 
+         i != observers.rend(); ++i)
+    {
+      (*i)->phase_done(test, phase);
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  Result TestsuiteBase::run_testcase(Testcase& test, CheckLog& checks)
+  {
+    checks.reset();
+    test.setTestsuite(*this);
+    test.setCheckLog(checks);
+    phase_start(test, SETUP);
+    test.setUp();
+    phase_done(test, SETUP);
+    phase_start(test, RUN);
+    Result retval = test.run();
+    phase_done(test, RUN);
+    phase_start(test, TEARDOWN);
+    test.tearDown();
+    phase_done(test, TEARDOWN);
+    return checks.aggregate(retval);
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::log_result(Logger& logger, Testcase& test, Result& retval)
+  {
+    if (retval.resval == FAILED) {
+      logger.test_failed(test, retval);
+    } else if (retval.resval == ERROR) {
+      logger.test_error(test, retval);
+    } else {
+      logger.test_passed(test);
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::log_checks(
+    Logger& logger, Testcase& test, CheckLog& checks, Result& retval)
+  {
+    for (CheckEntry* n = checks.getNotes(); n; n = n->next) {
+      Result res = n->result();
+      logger.test_info(test, res);
+    }
+    for (CheckEntry* f = checks.getFailures(); f; f = f->next) {
+      Result res = f->result();
+      logger.check_failed(test, res);
+    }
+    log_result(logger, test, retval);
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::repeat_testcase(
+    Testcase& test, const RunOptions& options, RepeatStats& stats,
+    size_t& next, bool& stop)
+  {
+    CheckLog log;
+    for (;;) {
+      #if ADAPTEST_THREADS
+      {
+        std::lock_guard<std::mutex> lock(repeat_mutex());
+        if (stop || (options.repeat && next >= options.repeat)) return;
+        next++;
+      }
+      #else
+        if (stop || (options.repeat && next >= options.repeat)) return;
+        next++;
+      #endif
+
+      // p.e. rows of a custom parameterized testcase without newInstance()
+      Testcase* instance = test.newInstance();
+      if (!instance) {
+        stats.add(Result(ERROR, test.getName(), 0,
+          "newInstance() returned 0, the testcase can't be repeated"), 0);
+        #if ADAPTEST_THREADS
+        std::lock_guard<std::mutex> lock(repeat_mutex());
+        #endif
+        stop = true;
+        return;
+      }
+
+      const double start = now_seconds();
+      const Result res = run_testcase(*instance, log);
+      const double seconds = now_seconds() - start;
+      delete instance;
+
+      stats.add(res, seconds);
+      if (res.resval != OK && options.until_fail) {
+        #if ADAPTEST_THREADS
+        std::lock_guard<std::mutex> lock(repeat_mutex());
+        #endif
+        stop = true;
+      }
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::run_repeated(
+    Testcase& test, Logger& logger, const RunOptions& options)
+  {
+    RepeatStats stats;
+    size_t next = 0;
+    bool stop = false;
+
+    #if ADAPTEST_THREADS
+      const size_t jobs = options.jobs ? options.jobs : 1;
+      std::vector<RepeatStats> partial(jobs);
+      std::vector<std::thread> threads;
+      for (size_t t = 1; t < jobs; ++t) {
+        threads.push_back(std::thread(&TestsuiteBase::repeat_testcase, this,
+          std::ref(test), std::cref(options), std::ref(partial[t]),
+          std::ref(next), std::ref(stop)));
+      }
+      repeat_testcase(test, options, partial[0], next, stop);
+      for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+      for (size_t t = 0; t < jobs; ++t) stats.merge(partial[t]);
+    #else
+      repeat_testcase(test, options, stats, next, stop);
+    #endif
+
+    Result info(OK, "", 0, stats.summary());
+    logger.test_info(test, info);
+
+    Result retval(OK);
+    if (stats.failures) {
+      const Result& first = stats.signatures.begin()->second.example;
+      retval = Result(stats.worst, first.test, first.line, format(
+        "{} of {} runs failed: {}", 
+        stats.failures, stats.runs, stats.histogram()));
+    }
+    log_result(logger, test, retval);
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::run_row_batch(
+    Testcase& test, const RunOptions& options, RowRun* runs,
+    size_t first, size_t count, size_t& next)
+  {
+    const bool all = options.testcase_selected(test.getName());
+    for (;;) {
+      size_t k;
+      #if ADAPTEST_THREADS
+      {
+        std::lock_guard<std::mutex> lock(repeat_mutex());
+        k = next++;
+      }
+      #else
+        k = next++;
+      #endif
+      if (k >= count) return;
+
+      RowRun& run = runs[k];
+      run.row = test.newRow(first + k);
+      if (!run.row) continue;
+      if (!all && !options.testcase_selected(run.row->getName())) {
+        delete run.row;
+        run.row = 0;
+        continue;
+      }
+      run.result = run_testcase(*run.row, run.checks);
+    }
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::run_rows(
+    Testcase& test, Logger& logger, const RunOptions& options)
+  {
+    const size_t rows = test.getRows();
+
+    if (options.repeating()) {
+      const bool all = options.testcase_selected(test.getName());
+      for (size_t r = 0; r < rows; ++r) {
+        Testcase* row = test.newRow(r);
+        if (!row) continue;
+        if (all || options.testcase_selected(row->getName())) {
+          logger.test_start(*row);
+          run_repeated(*row, logger, options);
+        }
+        delete row;
+      }
+      return;
+    }
+
+    #if ADAPTEST_THREADS
+      const size_t jobs = options.jobs ? options.jobs : 1;
+    #else
+      const size_t jobs = 1;
+    #endif
+    const size_t batch = jobs * 16;
+    RowRun* runs = new RowRun[batch];
+
+    for (size_t first = 0; first < rows; first += batch) {
+      const size_t count = rows - first < batch ? rows - first : batch;
+      size_t next = 0;
+
+      #if ADAPTEST_THREADS
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < jobs; ++t) {
+          threads.push_back(std::thread(&TestsuiteBase::run_row_batch, this,
+            std::ref(test), std::cref(options), runs, first, count,
+            std::ref(next)));
+        }
+        run_row_batch(test, options, runs, first, count, next);
+        for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+      #else
+        run_row_batch(test, options, runs, first, count, next);
+      #endif
+
+      for (size_t k = 0; k < count; ++k) {
+        if (!runs[k].row) continue;
+        logger.test_start(*runs[k].row);
+        log_checks(logger, *runs[k].row, runs[k].checks, runs[k].result);
+        delete runs[k].row;
+        runs[k].row = 0;
+      }
+    }
+
+    delete [] runs;
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void TestsuiteBase::run_tests(
+    Testcases& tests, Logger& logger, const RunOptions& options)
+  {
+    logger.testsuite_start(*this);
+
+    for (Testcases::iterator i = tests.begin(); i != tests.end(); ++i)
+    {
+      Testcase* test = i->second;
+      if (!options.testcase_selected(test->getName())
+          && !options.rows_selected(test->getName())) continue;
+
+      if (test->getRows()) {
+        run_rows(*test, logger, options);
+        continue;
+      }
+      if (!options.testcase_selected(test->getName())) continue;
+
+      logger.test_start(*test);
+
+      // run a fresh instance if possible, so the registered one stays
+      // untouched for following runs. repetitions require this.
+      Testcase* instance = test->newInstance();
+      if (instance && options.repeating()) {
+        delete instance;
+        run_repeated(*test, logger, options);
+        continue;
+      }
+
+      Result retval = run_testcase(instance ? *instance : *test, checks);
+      log_checks(logger, *test, checks, retval);
+      delete instance;
+    }
+
+    logger.testsuite_done(*this);
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  Testcases& testcase_list(Testcases*& storage)
+  {
+    if (!storage) storage = new Testcases();
+    return *storage;
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void add_testcase(Testcases& tests, Testcase* testcase, const int line)
+  {
+    tests[line] = testcase;
+  }
+
+  ADAPTEST_RUNNER_INLINE
+  void register_testsuite(TestsuiteBase* testsuite)
+  {
+    TestsuiteRegistration::add(testsuite);
+  }
+
+  // ========================================================================
+
+  // Logging unto the Console
+  // ------------------------
+  
+  // only known to the runner in build throughput mode
+  #if ADAPTEST_DEFAULT_LOGGER
+
+    class ConsoleLogger : public Logger {
+    private:
+        int num_tests;
+        int passed_tests;
+        int failed_tests;
+
+    public:
+
+      ConsoleLogger()
+        : num_tests(0)
+        , passed_tests(0)
+        , failed_tests(0)
+      {}
+
+      virtual ~ConsoleLogger() {
+        std::cout << num_tests
+          << " tests done: " 
+          << " passed: " << passed_tests 
+          << " failed: " << failed_tests
+          << std::endl;     
+      }
+
+      virtual void test_passed(Testcase& test)
+      {
+        passed_tests++;
+        num_tests++;
+      }
+
+      virtual void test_failed(Testcase& testcase, Result& res)
+      {
+        std::cout 
+          << std::right
+          #if ADAPTEST_AUTONAMES
+          << std::setw(40)
+          << testcase.getDesc()
+          #else
+          << std::setw(20)
+          << testcase.getName()
+          #endif
+          << " : "
+          << res.line
+          << " : "
+          << std::left
+          << std::setw(40)
+          << res.msg
+          << std::endl;
+        failed_tests++;
+        num_tests++;
+      }
+
+      virtual void check_failed(Testcase& testcase, Result& res)
+      {
+        std::cout 
+          << "CHECK : "
+          << std::right
+          #if ADAPTEST_AUTONAMES
+          << testcase.getDesc()
+          #else
+          << testcase.getName()
+          #endif
+          << " : "
+          << res.line
+          << " : "
+          << std::left
+          << std::setw(40)
+          << res.msg
+          << std::endl;
+      }
+
+      virtual void test_info(Testcase& testcase, Result& res)
+      {
+        std::cout 
+          << "INFO : "
+          << std::right
+          #if ADAPTEST_AUTONAMES
+          << testcase.getDesc()
+          #else
+          << testcase.getName()
+          #endif
+          << " : "
+          << res.line
+          << " : "
+          << res.msg
+          << std::endl;
+      }
+
+      virtual void artifact_error(Result& res)
+      {
+        std::cout 
+          << "ERROR : artifact : "
+          << res.line
+          << " : "
+          << res.msg
+          << std::endl;
+        failed_tests++;
+      }
+
+      virtual void testsuite_start(TestsuiteBase& suite)
+      {
+        std::cout << "processing testsuite " << suite.getName() << std::endl;
+      }
+
+      virtual void testsuite_done(TestsuiteBase& suite)   
+      {}
+
+      virtual void test_start(Testcase& testcase)
+      {}
+
+      virtual int getFailed()
+      { return failed_tests; }
+
+      virtual void test_error(Testcase& test, Result& res)
+      {
+        std::cout 
+          << "ERROR : "
+          << std::right
+          #if ADAPTEST_AUTONAMES
+          << test.getDesc()
+          #else
+          << test.getName()
+          #endif
+          << " : "
+          << res.line
+          << " : "
+          << std::left
+          << std::setw(40)
+          << res.msg
+          << std::endl;
+        failed_tests++;
+        num_tests++;
+      }
+    };  
+
+  #endif //ADAPTEST_DEFAULT_LOGGER
+
+  #endif // ADAPTEST_RUNNER_DEFINITIONS
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_RUNNER_H
@@ -0,0 +1,227 @@
+#ifndef ADAPTEST_SCALING_H
+#define ADAPTEST_SCALING_H
+
+#include <adaptest.h>
+#include <adaptest/buf.h>
+#include <adaptest/concurrent.h>
+
+// a Testcase Base Class for Adaptest which runs a callable on 1, 2, 4, ... up
+// to N threads and reports the throughput, the speedup and the parallel
+// efficiency per thread count. the test fails if the efficiency at any
+// thread count drops below a threshold, which reveals false sharing and lock
+// contention. with ADAPTEST_BUFWRITE_FILE the curves of a failed test are
+// written as CSV by the CSVBufferWriter and plotted over the thread count
+// into a dygraph HTML page. requires C++11.
+//
+//   class MyTestcase : public AdapTest::ScalingTestcase {};
+//   ...
+//   TEST(scaling, 8, 100000, [&](AdapTest::ConcurrentContext& ctx) {
+//     counter.fetch_add(1);
+//   }, "counter")
+
+// minimal parallel efficiency (speedup / threads) which passes
+#ifndef ADAPTEST_SCALING_EFFICIENCY
+#define ADAPTEST_SCALING_EFFICIENCY 0.5
+#endif // !ADAPTEST_SCALING_EFFICIENCY
+
+// runs per thread count, the fastest one is taken
+#ifndef ADAPTEST_SCALING_RUNS
+#define ADAPTEST_SCALING_RUNS 3
+#endif // !ADAPTEST_SCALING_RUNS
+
+// plot the curves of passing tests, too
+#ifndef ADAPTEST_SCALING_PLOT
+#define ADAPTEST_SCALING_PLOT 0
+#endif // !ADAPTEST_SCALING_PLOT
+
+// arguments are testsuite, testcase and the name of the test
+#ifndef ADAPTEST_SCALING_CSV_FILENAME_FORMAT
+#define ADAPTEST_SCALING_CSV_FILENAME_FORMAT "{}-{}-{}.csv"
+#endif // !ADAPTEST_SCALING_CSV_FILENAME_FORMAT
+
+#ifndef ADAPTEST_SCALING_HTML_FILENAME_FORMAT
+#define ADAPTEST_SCALING_HTML_FILENAME_FORMAT "{}-{}-{}.html"
+#endif // !ADAPTEST_SCALING_HTML_FILENAME_FORMAT
+
+#if ADAPTEST_BUFWRITE_FILE
+#include <adaptest/dygraph.h>
+#include <fstream>
+#endif // ADAPTEST_BUFWRITE_FILE
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+  class ScalingTestcase : public ConcurrentTestcase {
+  public:
+    virtual std::string& getName() = 0;
+    virtual std::string& getDesc() = 0;
+
+    double scaling_efficiency;
+    size_t scaling_runs;
+    bool scaling_plot;
+
+    ScalingTestcase()
+    : scaling_efficiency(ADAPTEST_SCALING_EFFICIENCY)
+    , scaling_runs(ADAPTEST_SCALING_RUNS)
+    , scaling_plot(ADAPTEST_SCALING_PLOT)
+    {}
+
+    // every thread calls callable(ConcurrentContext&) iterations times, so
+    // the work grows with the thread count. throughput is the number of calls
+    // per second from the first start to the last finish.
+    template <class Callable>
+    Result test_scaling(
+      size_t max_threads, size_t iterations, Callable callable,
+      std::string name, const int line)
+    {
+      if (!max_threads) {
+        std::string msg = format("{}: max_threads must be > 0", name);
+        return error(msg, line);
+      }
+
+      const size_t failuresBefore = failed_checks();
+
+      std::vector<double> threads, throughput, speedup, efficiency;
+      for (size_t n = 1; ; n = n * 2 < max_threads ? n * 2 : max_threads) {
+        double best = 0;
+        for (size_t run = 0; run < scaling_runs; ++run) {
+          const double seconds = measure(n, iterations, callable, name, line);
+          if (seconds > 0 && n * iterations / seconds > best) {
+            best = n * iterations / seconds;
+          }
+        }
+        threads.push_back(static_cast<double>(n));
+        throughput.push_back(best);
+        speedup.push_back(throughput[0] > 0 ? best / throughput[0] : 0);
+        efficiency.push_back(speedup.back() / n);
+        if (n >= max_threads) break;
+      }
+
+      std::stringstream report;
+      report << name << ":" << std::fixed;
+      std::string flagged;
+      for (size_t i = 0; i < threads.size(); ++i) {
+        report
+          << std::setprecision(0) << " " << threads[i] << " threads "
+          << throughput[i] << " calls/s speedup " << std::setprecision(2)
+          << speedup[i] << " efficiency " << std::setprecision(0)
+          << efficiency[i] * 100 << "%" << (i + 1 < threads.size() ? ";" : "");
+        if (flagged.empty() && efficiency[i] < scaling_efficiency) {
+          flagged = format("efficiency {}% at {} threads is below {}%",
+            static_cast<int>(efficiency[i] * 100), threads[i],
+            static_cast<int>(scaling_efficiency * 100));
+        }
+      }
+
+      Result res = check_failures(failuresBefore, max_threads, name, line);
+
+      #if ADAPTEST_BUFWRITE_FILE
+        if (res != OK || !flagged.empty() || scaling_plot) {
+          Result written =
+            write_plot(threads, throughput, speedup, efficiency, name, line);
+          if (res == OK && flagged.empty() && written != OK) return written;
+        }
+      #endif // ADAPTEST_BUFWRITE_FILE
+
+      if (res != OK) return res;
+
+      if (!flagged.empty()) {
+        return Result(FAILED, name, line,
+          format("{}: {}; {}", name, flagged, report.str()));
+      }
+      record_info(report.str(), line);
+      return OK;
+    }
+
+  private:
+  #if ADAPTEST_BUFWRITE_FILE
+    // the columns as CSV and a page with the throughput on the left axis,
+    // speedup and efficiency, which are around 1, on the right one
+    Result write_plot(
+      const std::vector<double>& threads,
+      const std::vector<double>& throughput,
+      const std::vector<double>& speedup,
+      const std::vector<double>& efficiency,
+      const std::string& name, const int line)
+    {
+      CSVBufferWriter<double> writer(line, *this);
+      BufferWriter<double>& columns = writer;
+      columns.add_buf(&threads[0], threads.size(), "threads");
+      columns.add_buf(&throughput[0], throughput.size(), "calls/s");
+      columns.add_buf(&speedup[0], speedup.size(), "speedup");
+      columns.add_buf(&efficiency[0], efficiency.size(), "efficiency");
+
+      // the column names head the CSV and label the plot
+      std::string header, labels;
+      typedef BufferWriter<double>::BufferList Columns;
+      for (Columns::iterator i = columns.getData().begin();
+           i != columns.getData().end(); ++i)
+      {
+        header += (header.empty() ? "" : ",") + i->name;
+        DygraphHtml::add_label(labels, i->name);
+      }
+
+      const std::string filename = format(
+        ADAPTEST_SCALING_CSV_FILENAME_FORMAT,
+        getTestsuite().getName(), getName(), name);
+      ArtifactObservation observation(filename);
+
+      std::fstream csv(filename.c_str(), std::ios::out);
+      if (!csv.good()) {
+        return columns.error(format("could not open {}", filename));
+      }
+      csv << header << "\n";
+      Result res = writer.write_buffers(csv);
+      if (res != OK) return res;
+
+      const std::string html_filename = format(
+        ADAPTEST_SCALING_HTML_FILENAME_FORMAT,
+        getTestsuite().getName(), getName(), name);
+      std::fstream html(html_filename.c_str(), std::ios::out);
+      if (!html.good()) {
+        return columns.error(format("could not open {}", html_filename));
+      }
+
+      DygraphHtml::write_header(html);
+      for (size_t i = 0; i < threads.size(); ++i) {
+        html
+          << "[" << threads[i] << "," << throughput[i] << "," << speedup[i]
+          << "," << efficiency[i] << "],";
+      }
+
+      DygraphHtml::write_footer(html, labels,
+        "xlabel: 'threads', ylabel: 'calls/s',"
+        "y2label: 'speedup, efficiency', drawPoints: true,"
+        "series: { 'speedup': { axis: 'y2' }, 'efficiency': { axis: 'y2' } },"
+        "axes: { y2: { independentTicks: true } },");
+      return OK;
+    }
+  #endif // ADAPTEST_BUFWRITE_FILE
+
+    // wall time in seconds of one run on nthreads threads
+    template <class Callable>
+    double measure(
+      size_t nthreads, size_t iterations, Callable& callable,
+      std::string& name, const int line)
+    {
+      std::vector<Clock::time_point> started, finished;
+      run_threads(nthreads, iterations, callable, name, line,
+                  started, finished);
+
+      Clock::time_point first = started[0], last = finished[0];
+      for (size_t t = 0; t < nthreads; ++t) {
+        if (started[t] < first) first = started[t];
+        if (finished[t] > last) last = finished[t];
+      }
+      return std::chrono::duration<double>(last - first).count();
+    }
+  };
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_SCALING_H
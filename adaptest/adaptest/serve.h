@@ -0,0 +1,408 @@
+#ifndef ADAPTEST_SERVE_H
+#define ADAPTEST_SERVE_H
+
+#include <adaptest.h>
+#include <adaptest/runner.h>
+
+// a warm runner for Adaptest. including this header into any translation unit
+// of a test binary enables "--serve <socket>": the binary keeps running with
+// all testsuites and their fixtures loaded and runs them upon requests on a
+// unix domain socket. the Logger events are streamed back as records, a
+// client (tools/client.cpp) replays them into a local Logger. requires POSIX.
+//
+// a request is one line of tab separated command line options, prefixed by
+// "run", or "quit" to stop the server. every record is one line
+//   type \t name \t desc \t line \t msg
+// with '\t', '\n' and '\\' escaped by '\\'. the types are
+//   S, s  testsuite start and done (name is the testsuite)
+//   T     test start
+//   P, F, E  test passed, failed and error
+//   C, I  check failed and info
+//   A     artifact error
+//   L     the name of a testsuite upon --list
+//   U     invalid request, msg says why
+//   D     the run is done, line is the number of failed tests
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Records
+  // -------
+
+  struct Record {
+    char type;
+    std::string name;
+    std::string desc;
+    int line;
+    std::string msg;
+
+    Record() : type(0), line(0) {}
+
+    Record(char _type, const std::string& _name, const std::string& _desc,
+           int _line, const std::string& _msg)
+    : type(_type)
+    , name(_name)
+    , desc(_desc)
+    , line(_line)
+    , msg(_msg)
+    {}
+
+    static void escape(std::string& out, const std::string& field) {
+      for (size_t i = 0; i < field.size(); ++i) {
+        switch (field[i]) {
+          case '\t': out += "\\t"; break;
+          case '\n': out += "\\n"; break;
+          case '\\': out += "\\\\"; break;
+          default:   out += field[i]; break;
+        }
+      }
+    }
+
+    std::string encode() const {
+      std::string out(1, type);
+      out += '\t';
+      escape(out, name);
+      out += '\t';
+      escape(out, desc);
+      out += format("\t{}\t", line);
+      escape(out, msg);
+      out += '\n';
+      return out;
+    }
+
+    // splits a line without its '\n' into unescaped fields
+    static std::vector<std::string> split(const std::string& line) {
+      std::vector<std::string> fields(1);
+      for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '\t') {
+          fields.push_back("");
+        } else if (line[i] == '\\' && i + 1 < line.size()) {
+          const char c = line[++i];
+          fields.back() += c == 't' ? '\t' : c == 'n' ? '\n' : c;
+        } else {
+          fields.back() += line[i];
+        }
+      }
+      return fields;
+    }
+
+    bool decode(const std::string& line) {
+      const std::vector<std::string> fields = split(line);
+      if (fields.size() != 5 || fields[0].size() != 1) return false;
+      type = fields[0][0];
+      name = fields[1];
+      desc = fields[2];
+      this->line = std::atoi(fields[3].c_str());
+      msg = fields[4];
+      return true;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // reads '\n' terminated lines from a socket
+  class LineReader {
+  private:
+    int fd;
+    std::string buffer;
+
+  public:
+    explicit LineReader(int _fd) : fd(_fd) {}
+
+    // false upon end of stream
+    bool read(std::string& line) {
+      for (;;) {
+        const size_t eol = buffer.find('\n');
+        if (eol != std::string::npos) {
+          line = buffer.substr(0, eol);
+          buffer.erase(0, eol + 1);
+          return true;
+        }
+        char chunk[4096];
+        const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+      }
+    }
+  };
+
+  // writes everything, false if the peer is gone
+  inline bool write_all(int fd, const std::string& data) {
+    #ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+    #else
+    const int flags = 0;
+    #endif
+    for (size_t done = 0; done < data.size(); ) {
+      const ssize_t n = ::send(fd, data.data() + done, data.size() - done, flags);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      done += n;
+    }
+    return true;
+  }
+
+  // ================================================================
+
+  // Socket Logger
+  // -------------
+
+  // streams every event as a record
+  class SocketLogger : public Logger {
+  private:
+    int fd;
+    bool connected;
+    int failed_tests;
+
+    void send(char type, Testcase& test, const Result& res) {
+      send(Record(type, test.getName(), test.getDesc(), res.line, res.msg));
+    }
+
+  public:
+    explicit SocketLogger(int _fd)
+    : fd(_fd)
+    , connected(true)
+    , failed_tests(0)
+    {}
+
+    // a gone client doesn't stop the run
+    void send(const Record& record) {
+      if (connected) connected = write_all(fd, record.encode());
+    }
+
+    virtual void test_start(Testcase& test) { send('T', test, Result(OK)); }
+    virtual void test_passed(Testcase& test) { send('P', test, Result(OK)); }
+
+    virtual void test_failed(Testcase& test, Result& res) {
+      send('F', test, res);
+      failed_tests++;
+    }
+
+    virtual void test_error(Testcase& test, Result& res) {
+      send('E', test, res);
+      failed_tests++;
+    }
+
+    virtual void check_failed(Testcase& test, Result& res) {
+      send('C', test, res);
+    }
+
+    virtual void test_info(Testcase& test, Result& res) {
+      send('I', test, res);
+    }
+
+    virtual void artifact_error(Result& res) {
+      send(Record('A', "", "", res.line, res.msg));
+      failed_tests++;
+    }
+
+    virtual void testsuite_start(TestsuiteBase& suite) {
+      send(Record('S', suite.getName(), "", 0, ""));
+    }
+
+    virtual void testsuite_done(TestsuiteBase& suite) {
+      send(Record('s', suite.getName(), "", 0, ""));
+    }
+
+    virtual int getFailed() { return failed_tests; }
+  };
+
+  // ================================================================
+
+  // Replay
+  // ------
+
+  // stand-ins for the testsuites and testcases of the server
+  class RemoteTestcase : public Testcase {
+  private:
+    std::string name;
+    std::string desc;
+
+  public:
+    RemoteTestcase(const std::string& _name, const std::string& _desc)
+    : name(_name)
+    , desc(_desc)
+    {}
+
+    virtual std::string& getName() { return name; }
+    virtual std::string& getDesc() { return desc; }
+    virtual Result run() { return OK; }
+  };
+
+  class RemoteTestsuite : public TestsuiteBase {
+  public:
+    explicit RemoteTestsuite(const std::string& name)
+    : TestsuiteBase(name.c_str(), "")
+    {}
+
+    virtual void run(Logger&, const RunOptions&) {}
+  };
+
+  // passes the records of one run to a local Logger
+  class RecordReplay {
+  private:
+    Logger& logger;
+    std::unique_ptr<RemoteTestsuite> suite;
+
+  public:
+    explicit RecordReplay(Logger& _logger) : logger(_logger) {}
+
+    // false if the record is unknown
+    bool replay(const Record& record) {
+      RemoteTestcase test(record.name, record.desc);
+      Result res(OK, "", record.line, record.msg);
+
+      switch (record.type) {
+        case 'S':
+          suite.reset(new RemoteTestsuite(record.name));
+          logger.testsuite_start(*suite);
+          break;
+        case 's':
+          if (suite) logger.testsuite_done(*suite);
+          suite.reset();
+          break;
+        case 'T': logger.test_start(test); break;
+        case 'P': logger.test_passed(test); break;
+        case 'F': res.resval = FAILED; logger.test_failed(test, res); break;
+        case 'E': res.resval = ERROR;  logger.test_error(test, res); break;
+        case 'C': res.resval = FAILED; logger.check_failed(test, res); break;
+        case 'I': logger.test_info(test, res); break;
+        case 'A': res.resval = ERROR;  logger.artifact_error(res); break;
+        default: return false;
+      }
+      return true;
+    }
+  };
+
+  // ================================================================
+
+  // Server
+  // ------
+
+  class UnixSocketServer : public RunServer {
+  private:
+    // handles one connection, false upon quit
+    bool handle(int fd) {
+      LineReader reader(fd);
+      std::string request;
+      if (!reader.read(request)) return true;
+
+      std::vector<std::string> args = Record::split(request);
+      if (args[0] == "quit") return false;
+      if (args[0] != "run") {
+        write_all(fd, Record('U', "", "", 0, "unknown request").encode());
+        return true;
+      }
+
+      std::vector<const char*> argv;
+      argv.push_back("serve");
+      for (size_t i = 1; i < args.size(); ++i) argv.push_back(args[i].c_str());
+
+      RunOptions options;
+      if (!parse_options(static_cast<int>(argv.size()), &argv[0], options)
+          || !options.serve.empty())
+      {
+        write_all(fd, Record('U', "", "", 0, "invalid options").encode());
+        return true;
+      }
+
+      SocketLogger logger(fd);
+      int failed = 0;
+      if (options.list) {
+        Testsuites& suites = TestsuiteRegistration::testsuites();
+        for (Testsuites::iterator i = suites.begin(); i != suites.end(); ++i) {
+          logger.send(Record('L', (*i)->getName(), "", 0, ""));
+        }
+      } else {
+        failed = TestsuiteRegistration::run(logger, options);
+      }
+      logger.send(Record('D', "", "", failed, ""));
+      return true;
+    }
+
+    // remove a stale socket at path. anything else at path is left alone.
+    static bool remove_socket(const char* path) {
+      struct stat st;
+      if (::lstat(path, &st)) return errno == ENOENT;
+      if (!S_ISSOCK(st.st_mode)) {
+        errno = EEXIST;
+        return false;
+      }
+      return ::unlink(path) == 0;
+    }
+
+  public:
+    static UnixSocketServer& instance() {
+      static UnixSocketServer server;
+      return server;
+    }
+
+    virtual int serve(const RunOptions& options) {
+      sockaddr_un addr;
+      std::memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      if (options.serve.size() >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "socket path too long: %s\n",
+                     options.serve.c_str());
+        return 2;
+      }
+      std::strcpy(addr.sun_path, options.serve.c_str());
+
+      if (!remove_socket(addr.sun_path)) {
+        std::fprintf(stderr, "could not listen on %s: %s\n", addr.sun_path,
+          errno == EEXIST ? "not a socket" : std::strerror(errno));
+        return 2;
+      }
+
+      const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (listener < 0
+          || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+          || listen(listener, 8))
+      {
+        std::fprintf(stderr, "could not listen on %s: %s\n",
+                     addr.sun_path, std::strerror(errno));
+        if (listener >= 0) ::close(listener);
+        return 2;
+      }
+      std::printf("serving on %s\n", addr.sun_path);
+      std::fflush(stdout);
+
+      for (bool running = true; running; ) {
+        const int fd = accept(listener, 0, 0);
+        if (fd < 0) {
+          if (errno == EINTR) continue;
+          break;
+        }
+        running = handle(fd);
+        ::close(fd);
+      }
+
+      ::close(listener);
+      remove_socket(addr.sun_path);
+      return 0;
+    }
+  };
+
+  // registers the server by including this header
+  static struct ServeRegistration {
+    ServeRegistration() {
+      TestsuiteRegistration::server() = &UnixSocketServer::instance();
+    }
+  } serveRegistration;
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_SERVE_H
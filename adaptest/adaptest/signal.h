@@ -0,0 +1,266 @@
+#ifndef ADAPTEST_SIGNAL_H
+#define ADAPTEST_SIGNAL_H
+
+#include <adaptest.h>
+
+// deterministic test signals for the fixtures of BufferTestcase: ramps,
+// sines, chirps, white and pink noise, impulses and random integers. the
+// generators are plain scalar loops. white noise and random integers are
+// derived from the seed and the sample index only, pink noise carries its
+// rows from sample to sample. all signals are cached for the whole run and
+// shared read only, identical fixtures of many testcases are generated once,
+// so generating them stays off the hot path. requires C++11.
+//
+//   Signal<float> in = signal_sine<float>(4096, 0.01);
+//   TEST(buf, in.size(), in.data(), expected, "in")
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // a read only buffer shared by all testcases which asked for it
+  template <class T>
+  class Signal {
+  private:
+    std::shared_ptr<const std::vector<T> > buffer;
+
+  public:
+    Signal() : buffer(new std::vector<T>()) {}
+
+    explicit Signal(std::shared_ptr<const std::vector<T> > _buffer)
+    : buffer(_buffer)
+    {}
+
+    const T* data() const { return buffer->empty() ? 0 : &(*buffer)[0]; }
+    size_t size() const { return buffer->size(); }
+    const T& operator [] (size_t i) const { return (*buffer)[i]; }
+    const std::vector<T>& vector() const { return *buffer; }
+  };
+
+  //--------------------------------------------------------------------------
+
+  // the signals of this run by their generator and parameters
+  class SignalCache {
+  private:
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const void> > signals;
+
+  public:
+    static SignalCache& instance() {
+      static SignalCache cache;
+      return cache;
+    }
+
+    // the cached signal of key, generate(T* out, size_t length) fills it
+    // upon the first request
+    template <class T, class Generate>
+    Signal<T> get(std::string key, size_t length, Generate generate) {
+      key += typeid(T).name();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, std::shared_ptr<const void> >::iterator i =
+          signals.find(key);
+        if (i != signals.end()) {
+          return Signal<T>(
+            std::static_pointer_cast<const std::vector<T> >(i->second));
+        }
+      }
+
+      // generated unlocked, a concurrent duplicate is dropped
+      std::shared_ptr<std::vector<T> > buffer(new std::vector<T>(length));
+      if (length) generate(&(*buffer)[0], length);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      std::shared_ptr<const void>& cached = signals[key];
+      if (!cached) cached = buffer;
+      return Signal<T>(std::static_pointer_cast<const std::vector<T> >(cached));
+    }
+
+    size_t size() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return signals.size();
+    }
+
+    // signals still in use stay valid
+    void clear() {
+      std::lock_guard<std::mutex> lock(mutex);
+      signals.clear();
+    }
+  };
+
+  // builds the cache key from the exact bits of the parameters
+  class SignalKey {
+  private:
+    std::string key;
+
+  public:
+    explicit SignalKey(const char* generator) : key(generator) {
+      key += '\0';
+    }
+
+    template <class P>
+    SignalKey& operator << (const P& param) {
+      key.append(reinterpret_cast<const char*>(&param), sizeof(param));
+      return *this;
+    }
+
+    operator const std::string& () const { return key; }
+  };
+
+  // ================================================================
+
+  // Generators
+  // ----------
+
+  namespace signal_detail {
+
+    // splitmix64 of the index, a counter based generator
+    inline unsigned long long random(unsigned long long seed,
+                                     unsigned long long index)
+    {
+      unsigned long long z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    // uniform in [-1, 1)
+    inline double uniform(unsigned long long seed, unsigned long long index) {
+      return (random(seed, index) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+    }
+
+    const double pi = 3.14159265358979323846;
+
+  } // namespace signal_detail
+
+  // start, start + step, start + 2 * step, ...
+  template <class T>
+  Signal<T> signal_ramp(size_t length, T start = T(0), T step = T(1)) {
+    return SignalCache::instance().get<T>(
+      SignalKey("ramp") << length << start << step, length,
+      [start, step](T* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = T(start + step * T(i));
+      });
+  }
+
+  // frequency in cycles per sample
+  template <class T>
+  Signal<T> signal_sine(size_t length, double frequency,
+                        double amplitude = 1.0, double phase = 0.0)
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("sine") << length << frequency << amplitude << phase, length,
+      [frequency, amplitude, phase](T* out, size_t n) {
+        const double w = 2 * signal_detail::pi * frequency;
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = T(amplitude * std::sin(w * double(i) + phase));
+        }
+      });
+  }
+
+  // a linear sweep from frequency f0 to f1 in cycles per sample
+  template <class T>
+  Signal<T> signal_chirp(size_t length, double f0, double f1,
+                         double amplitude = 1.0)
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("chirp") << length << f0 << f1 << amplitude, length,
+      [f0, f1, amplitude](T* out, size_t n) {
+        const double rate = n > 1 ? (f1 - f0) / double(n - 1) : 0;
+        for (size_t i = 0; i < n; ++i) {
+          const double t = double(i);
+          out[i] = T(amplitude * std::sin(
+            2 * signal_detail::pi * (f0 * t + 0.5 * rate * t * t)));
+        }
+      });
+  }
+
+  // uniform in [-amplitude, amplitude)
+  template <class T>
+  Signal<T> signal_white_noise(size_t length, unsigned long long seed,
+                               double amplitude = 1.0)
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("white") << length << seed << amplitude, length,
+      [seed, amplitude](T* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = T(amplitude * signal_detail::uniform(seed, i));
+        }
+      });
+  }
+
+  // 1/f noise in [-amplitude, amplitude) by the Voss-McCartney algorithm:
+  // row r of 16 white rows is renewed every 2^r samples
+  template <class T>
+  Signal<T> signal_pink_noise(size_t length, unsigned long long seed,
+                              double amplitude = 1.0)
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("pink") << length << seed << amplitude, length,
+      [seed, amplitude](T* out, size_t n) {
+        const int nrows = 16;
+        double rows[nrows];
+        double total = 0;
+        unsigned long long next = 0;
+        for (int r = 0; r < nrows; ++r) {
+          rows[r] = signal_detail::uniform(seed, next++);
+          total += rows[r];
+        }
+        const double scale = amplitude / (nrows + 1);
+        for (size_t i = 0; i < n; ++i) {
+          if (i) {
+            int r = 0;
+            while (!((i >> r) & 1)) ++r;
+            if (r < nrows) {
+              const double renewed = signal_detail::uniform(seed, next++);
+              total += renewed - rows[r];
+              rows[r] = renewed;
+            }
+          }
+          const double white = signal_detail::uniform(~seed, i);
+          out[i] = T(scale * (total + white));
+        }
+      });
+  }
+
+  // amplitude at position, 0 elsewhere
+  template <class T>
+  Signal<T> signal_impulse(size_t length, size_t position = 0,
+                           T amplitude = T(1))
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("impulse") << length << position << amplitude, length,
+      [position, amplitude](T* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = i == position ? amplitude : T(0);
+      });
+  }
+
+  // uniform integers in [min, max]
+  template <class T>
+  Signal<T> signal_random_ints(size_t length, unsigned long long seed,
+                               T min, T max)
+  {
+    return SignalCache::instance().get<T>(
+      SignalKey("ints") << length << seed << min << max, length,
+      [seed, min, max](T* out, size_t n) {
+        // 0 is the whole range of a 64 bit type
+        const unsigned long long range =
+          static_cast<unsigned long long>(max) -
+          static_cast<unsigned long long>(min) + 1;
+        for (size_t i = 0; i < n; ++i) {
+          const unsigned long long r = signal_detail::random(seed, i);
+          out[i] = T(static_cast<unsigned long long>(min)
+                     + (range ? r % range : r));
+        }
+      });
+  }
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_SIGNAL_H
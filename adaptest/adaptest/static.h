@@ -0,0 +1,127 @@
+#ifndef ADAPTEST_STATIC_H
+#define ADAPTEST_STATIC_H
+
+#include <adaptest.h>
+
+// compile time tests for Adaptest. STATIC_TEST() is a static_assert with the
+// arguments of TEST() inside a TESTSUITE() body, which also registers a
+// testcase named static_test_<line> so the Logger counts and reports it.
+// STATIC_ASSERT_TEST() is the bare static_assert for namespace scope and
+// function bodies, the Logger never sees it. the body of a
+// CONSTEXPR_TESTCASE() is evaluated by the compiler, its CONSTEXPR_TEST()
+// checks fail the build, not the run. the error notes the failed check in
+// the constexpr expansion of constexpr_test_failed(). the registered
+// testcases pass at runtime without running anything. everything checked
+// has to be a constant expression, everything else belongs into TEST().
+// requires C++17.
+//
+//   constexpr int square(int x) { return x * x; }
+//   STATIC_ASSERT_TEST(eq, 16, square(4), "square")
+//
+//   STATIC_TEST(eq, 9, square(3), "square")
+//
+//   CONSTEXPR_TESTCASE(squares, "")
+//     int sum = 0;
+//     for (int i = 1; i <= 3; ++i) sum += square(i);
+//     CONSTEXPR_TEST(eq, 14, sum, "sum")
+//   END_CONSTEXPR_TESTCASE()
+
+namespace ADAPTEST_NAMESPACE {
+
+  // Static Test Functions
+  // ---------------------
+
+  // constexpr counterparts of the test functions of Testcase
+
+  template <class A, class B>
+  constexpr bool static_test_eq(const A& expected, const B& value, const char*)
+  {
+    return expected == value;
+  }
+
+  constexpr bool static_test_true(bool value, const char*) { return value; }
+
+  constexpr bool static_test_false(bool value, const char*) { return !value; }
+
+  // not constexpr: reaching it ends the constant evaluation
+  inline void constexpr_test_failure(const char*) {}
+
+  // a failed CONSTEXPR_TEST() calls this with the text of the check, the
+  // compiler notes the call with its argument before reporting the error
+  constexpr bool constexpr_test_failed(const char* check) {
+    return !check || (constexpr_test_failure(check), false);
+  }
+
+} // namespace ADAPTEST_NAMESPACE
+
+// Compile Time Tests
+// ------------------
+
+#define STATIC_ASSERT_TEST(testtype, ...)                                      \
+  static_assert(ADAPTEST_NAMESPACE::static_test_##testtype(__VA_ARGS__),      \
+                "STATIC_TEST(" #testtype ", " #__VA_ARGS__ ") failed");
+
+// resolving TONICTEST_NAME before pasting the registration name
+#define STATIC_TEST(testtype, ...)                                             \
+  STATIC_TEST_(TONICTEST_NAME( static_test_ ), testtype, __VA_ARGS__)
+#define STATIC_TEST_(_name, testtype, ...)                                     \
+  STATIC_TEST__(_name, testtype, __VA_ARGS__)
+
+// the testcase passes at runtime, the static_assert failed the build else
+#define STATIC_TEST__(_name, testtype, ...)                                    \
+  STATIC_ASSERT_TEST(testtype, __VA_ARGS__)                                    \
+  class _name;                                                                 \
+  TestcaseRegistration<_name, __LINE__> _name##Reg;                            \
+  class _name : public LocalTestcase {                                         \
+    std::string name;                                                          \
+    std::string desc;                                                          \
+    public:                                                                    \
+    _name()                                                                    \
+    : name(#_name)                                                             \
+    , desc("STATIC_TEST(" #testtype ", " #__VA_ARGS__ ")")                     \
+    {}                                                                         \
+    virtual std::string& getName() { return name; }                            \
+    virtual std::string& getDesc() { return desc; }                            \
+    virtual ADAPTEST_NAMESPACE::Testcase* newInstance() { return new _name(); }\
+    virtual ADAPTEST_NAMESPACE::Result run() { return ADAPTEST_NAMESPACE::OK; }\
+  };
+
+#define CONSTEXPR_TEST(testtype, ...)  {                                       \
+  if (!ADAPTEST_NAMESPACE::static_test_##testtype(__VA_ARGS__))               \
+    ADAPTEST_NAMESPACE::constexpr_test_failed(                                 \
+      "CONSTEXPR_TEST(" #testtype ", " #__VA_ARGS__ ") failed");               \
+}
+
+#if ADAPTEST_AUTONAMES == 1
+#define CONSTEXPR_TESTCASE(_desc)                                              \
+  CONSTEXPR_TESTCASE__( TONICTEST_NAME( testcase_ ), _desc )
+#define CONSTEXPR_TESTCASE__(_name, _desc) CONSTEXPR_TESTCASE_(_name, _desc)
+#else
+#define CONSTEXPR_TESTCASE(_name, _desc) CONSTEXPR_TESTCASE_(_name, _desc)
+#endif
+
+// the body is a constexpr lambda which initializes a constexpr variable, so
+// the compiler has to evaluate it
+#define CONSTEXPR_TESTCASE_(_name, _desc)                                      \
+  class _name;                                                                 \
+  TestcaseRegistration<_name, __LINE__> _name##Reg;                            \
+  class _name : public LocalTestcase {                                         \
+    std::string name;                                                          \
+    std::string desc;                                                          \
+    public:                                                                    \
+    _name() : name(#_name), desc(_desc) {}                                     \
+    virtual std::string& getName() { return name; }                            \
+    virtual std::string& getDesc() { return desc; }                            \
+    virtual ADAPTEST_NAMESPACE::Testcase* newInstance() { return new _name(); }\
+    virtual ADAPTEST_NAMESPACE::Result run() {                                 \
+      constexpr bool passed = []() constexpr {                                 \
+
+#define END_CONSTEXPR_TESTCASE()                                               \
+        return true;                                                           \
+      }();                                                                     \
+      static_assert(passed, "CONSTEXPR_TESTCASE failed");                      \
+      return ADAPTEST_NAMESPACE::OK;                                           \
+    }                                                                          \
+  };                                                                           \
+
+#endif //ADAPTEST_STATIC_H
@@ -0,0 +1,215 @@
+#ifndef ADAPTEST_TRACE_H
+#define ADAPTEST_TRACE_H
+
+#include <adaptest.h>
+#include <adaptest/runner.h>
+
+// a Logger for Adaptest which records a timeline of the whole run: every
+// testsuite, testcase, setUp(), run(), tearDown() and artifact write with the
+// thread it ran on. the events are collected per thread and written as Chrome
+// trace event JSON when the logger is destroyed, viewable in Perfetto or
+// chrome://tracing. all calls are passed on to another Logger.
+// requires C++11.
+//
+//   ADAPTEST_MAIN(TraceLogger)  // a ConsoleLogger which traces
+
+#ifndef ADAPTEST_TRACE_FILENAME
+#define ADAPTEST_TRACE_FILENAME "adaptest-trace.json"
+#endif // !ADAPTEST_TRACE_FILENAME
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ADAPTEST_NAMESPACE {
+
+  // the events of one thread, only written by this thread
+  class TraceThread {
+  public:
+    struct Event {
+      std::string name;
+      const char* category;
+      double start;     // microseconds since the logger was created
+      double duration;
+    };
+
+    // an event which has started but not finished yet
+    struct Open {
+      const void* key;
+      Event event;
+    };
+
+    const int tid;
+    std::string name;
+    std::vector<Event> events;
+    std::vector<Open> open;
+
+    TraceThread(int _tid, const std::string& _name)
+    : tid(_tid)
+    , name(_name)
+    {}
+
+    void begin(const void* key, const std::string& name,
+               const char* category, double now)
+    {
+      Open o = { key, { name, category, now, 0 } };
+      open.push_back(o);
+    }
+
+    // spans usually nest, the testcases of an async suite overlap
+    void end(const void* key, const char* category, double now) {
+      for (size_t i = open.size(); i > 0; --i) {
+        Open& o = open[i - 1];
+        if (o.key != key || std::strcmp(o.event.category, category)) continue;
+        o.event.duration = now - o.event.start;
+        events.push_back(o.event);
+        open.erase(open.begin() + (i - 1));
+        return;
+      }
+    }
+  };
+
+  //--------------------------------------------------------------------------
+
+  template <class InnerLogger>
+  class TracingLogger : public InnerLogger, public RunObserver {
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    const Clock::time_point origin;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceThread> > threads;
+
+    static const char* category(Phase phase) {
+      return phase == SETUP ? "setUp" : phase == RUN ? "run" : "tearDown";
+    }
+
+    double now() const {
+      return std::chrono::duration<double, std::micro>(
+        Clock::now() - origin).count();
+    }
+
+    // the buffer of the calling thread, created upon its first event
+    TraceThread& thread() {
+      static thread_local TracingLogger* owner = 0;
+      static thread_local TraceThread* local = 0;
+      if (owner != this || !local) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const int tid = static_cast<int>(threads.size());
+        threads.push_back(std::unique_ptr<TraceThread>(new TraceThread(
+          tid, tid ? format("worker {}", tid) : std::string("main"))));
+        owner = this;
+        local = threads.back().get();
+      }
+      return *local;
+    }
+
+    static void escape(std::ostream& out, const std::string& text) {
+      out << '"';
+      for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = text[i];
+        if (c == '"' || c == '\\') {
+          out << '\\' << c;
+        } else if (c < 0x20) {
+          char hex[8];
+          std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+          out << hex;
+        } else {
+          out << c;
+        }
+      }
+      out << '"';
+    }
+
+    void write() {
+      std::ofstream json(ADAPTEST_TRACE_FILENAME);
+      json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+      json.precision(3);
+      json << std::fixed;
+      bool first = true;
+      for (size_t t = 0; t < threads.size(); ++t) {
+        const TraceThread& thread = *threads[t];
+        json << (first ? "" : ",\n")
+             << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+             << thread.tid << ",\"args\":{\"name\":";
+        escape(json, thread.name);
+        json << "}}";
+        first = false;
+
+        for (size_t e = 0; e < thread.events.size(); ++e) {
+          const TraceThread::Event& event = thread.events[e];
+          json << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.tid
+               << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+               << ",\"cat\":\"" << event.category << "\",\"name\":";
+          escape(json, event.name);
+          json << "}";
+        }
+      }
+      json << "\n]}\n";
+      if (!json.good()) {
+        std::fprintf(stderr, "could not write %s\n", ADAPTEST_TRACE_FILENAME);
+      }
+    }
+
+  public:
+    TracingLogger()
+    : origin(Clock::now())
+    {
+      TestsuiteRegistration::addObserver(this);
+    }
+
+    virtual ~TracingLogger() {
+      TestsuiteRegistration::removeObserver(this);
+      write();
+    }
+
+    // Logger, called on the main thread
+
+    virtual void testsuite_start(TestsuiteBase& suite) {
+      thread().begin(&suite, suite.getName(), "testsuite", now());
+      InnerLogger::testsuite_start(suite);
+    }
+
+    virtual void testsuite_done(TestsuiteBase& suite) {
+      InnerLogger::testsuite_done(suite);
+      thread().end(&suite, "testsuite", now());
+    }
+
+    // RunObserver, called on the thread running the testcase
+
+    // a testcase spans from setUp() to the end of tearDown()
+    virtual void phase_start(Testcase& test, Phase phase) {
+      TraceThread& local = thread();
+      const double ts = now();
+      if (phase == SETUP) local.begin(&test, test.getName(), "testcase", ts);
+      local.begin(&test, category(phase), category(phase), ts);
+    }
+
+    virtual void phase_done(Testcase& test, Phase phase) {
+      TraceThread& local = thread();
+      const double ts = now();
+      local.end(&test, category(phase), ts);
+      if (phase == TEARDOWN) local.end(&test, "testcase", ts);
+    }
+
+    virtual void artifact_start(const std::string& name) {
+      thread().begin(&name, name, "artifact", now());
+    }
+
+    virtual void artifact_done(const std::string& name) {
+      thread().end(&name, "artifact", now());
+    }
+  };
+
+  #if ADAPTEST_DEFAULT_LOGGER && ADAPTEST_RUNNER_DEFINITIONS
+  typedef TracingLogger<ConsoleLogger> TraceLogger;
+  #endif // ADAPTEST_DEFAULT_LOGGER && ADAPTEST_RUNNER_DEFINITIONS
+
+} // namespace ADAPTEST_NAMESPACE
+
+#endif //ADAPTEST_TRACE_H
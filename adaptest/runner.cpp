@@ -0,0 +1,12 @@
+// the runner translation unit of the build throughput mode. compile every
+// testsuite translation unit with ADAPTEST_LEAN=1 and link them with this
+// file, which compiles adaptest/runner.h, the ConsoleLogger and main() once.
+// to use another Logger, copy this file and change ADAPTEST_MAIN().
+
+#ifndef ADAPTEST_LEAN
+#define ADAPTEST_LEAN 1
+#endif
+#define ADAPTEST_RUNNER
+#include <adaptest.h>
+
+ADAPTEST_MAIN(ConsoleLogger)
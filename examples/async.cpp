@@ -0,0 +1,59 @@
+#include <adaptest.h>
+#include <adaptest/async.h>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std::chrono;
+
+class SocketTestcase : public AdapTest::AsyncTestcase {
+public:
+	int fds[2];
+	virtual void setUp() {
+		socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+	}
+	virtual void tearDown() {
+		close(fds[0]);
+		close(fds[1]);
+	}
+	// a helper coroutine, co_await it to get its Result
+	AdapTest::AsyncResult echo(const char* msg) {
+		CO_TEST(true, co_await AdapTest::writable(fds[0], 100), "writable")
+		write(fds[0], msg, strlen(msg));
+		CO_TEST(true, co_await AdapTest::readable(fds[1], 100), "readable")
+		char buf[64] = { 0 };
+		read(fds[1], buf, sizeof(buf) - 1);
+		CO_TEST(eq, std::string(msg), std::string(buf), "echo")
+		co_return AdapTest::OK;
+	}
+};
+
+// the sleeping testcases run concurrently, the suite takes about 100ms
+TESTSUITE_ASYNC(AsyncSuite, SocketTestcase, "")
+	TESTCASE_ASYNC(SleepA, "")
+		co_await AdapTest::sleep_for(milliseconds(100));
+	END_TESTCASE_ASYNC()
+	TESTCASE_ASYNC(SleepB, "")
+		co_await AdapTest::sleep_for(milliseconds(100));
+	END_TESTCASE_ASYNC()
+	TESTCASE_ASYNC(Echo, "")
+		AdapTest::Result first = co_await echo("hello");
+		if (first.resval != AdapTest::OK) co_return first;
+		co_return co_await echo("world");
+	END_TESTCASE_ASYNC()
+	TESTCASE_ASYNC(Timeout, "")
+		// nothing was written, so waiting for data times out
+		CO_TEST(false, co_await AdapTest::readable(fds[1], 50), "readable")
+	END_TESTCASE_ASYNC()
+	TESTCASE_ASYNC(Future, "")
+		std::future<int> answer = std::async(std::launch::async, []() {
+			std::this_thread::sleep_for(milliseconds(50));
+			return 42;
+		});
+		CO_TEST(eq, 42, co_await AdapTest::ready(answer), "answer")
+	END_TESTCASE_ASYNC()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
@@ -17,6 +17,13 @@ TESTSUITE(MyTestsuite, SpecializedTestcase, "a simple Testsuite")
     TEST(true,  mybool, "mybool") // will fail
   END_TESTCASE()  
 
+  TESTCASE(mySoftTest, "a Test which reports all failures")
+    int i = 2;
+    CHECK(eq, 1, i, "i")           // will fail, but continue
+    CHECK(eq, 2, i, "i")
+    CHECK(true, i == 3, "i == 3")  // will fail as well
+  END_TESTCASE()
+
 END_TESTSUITE()
 
 ADAPTEST_MAIN(ConsoleLogger)
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include <adaptest.h>
+#include <adaptest/bench.h>
+#include <algorithm>
+#include <vector>
+
+class SpecializedTestcase : public AdapTest::BenchmarkTestcase {
+public:
+	std::vector<int> data;
+	virtual void setUp() {
+		data.resize(10000);
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] = (int)((i * 7919) % data.size());
+		}
+	}
+};
+
+// the first run records the baselines, following runs compare against them.
+// set ADAPTEST_UPDATE_BASELINE=1 to record new baselines.
+TESTSUITE(Benchmarks, SpecializedTestcase, "")
+	TESTCASE(Sort, "")
+		TEST(bench, 10, [&]() {
+			std::vector<int> copy(data);
+			std::sort(copy.begin(), copy.end());
+		}, "sort")
+	END_TESTCASE()
+
+	// both are sampled in turns on cpu 0, so drift hits them alike
+	TESTCASE(SortVsStable, "")
+		bench_cpu = 0;
+		add_bench("sort", 10, [&]() {
+			std::vector<int> copy(data);
+			std::sort(copy.begin(), copy.end());
+		});
+		add_bench("stable_sort", 10, [&]() {
+			std::vector<int> copy(data);
+			std::stable_sort(copy.begin(), copy.end());
+		});
+		TEST(benches, "sorts")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
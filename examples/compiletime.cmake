@@ -0,0 +1,77 @@
+# measures the build cost of testsuite translation units with the full header
+# and in build throughput mode (ADAPTEST_LEAN). every translation unit is
+# compiled REPEAT times, the fastest run is reported together with the size
+# of the preprocessed source. the table is printed and written to OUTPUT.
+#
+#   cmake -DCOMPILER=g++ -DFLAGS=-std=c++11 -DINCLUDE=../adaptest
+#         -DSOURCES="multi_a.cpp|multi_b.cpp" -DRUNNER=../adaptest/runner.cpp
+#         -DOUTPUT=compiletime.csv -P compiletime.cmake
+
+cmake_minimum_required(VERSION 3.23)
+
+if(NOT REPEAT)
+  set(REPEAT 3)
+endif()
+separate_arguments(FLAGS)
+string(REPLACE "|" ";" SOURCES "${SOURCES}")
+set(scratch "${CMAKE_CURRENT_BINARY_DIR}/compiletime.tmp")
+
+# fastest of REPEAT compilations in milliseconds and preprocessed KiB
+function(measure source defines ms_var kib_var)
+  set(best "")
+  foreach(i RANGE 1 ${REPEAT})
+    string(TIMESTAMP start "%s%f")
+    execute_process(
+      COMMAND ${COMPILER} ${FLAGS} ${defines} -I${INCLUDE} -c ${source}
+              -o ${scratch}.o
+      RESULT_VARIABLE failed)
+    string(TIMESTAMP stop "%s%f")
+    if(failed)
+      message(FATAL_ERROR "could not compile ${source}")
+    endif()
+    math(EXPR us "${stop} - ${start}")
+    if(best STREQUAL "" OR us LESS best)
+      set(best ${us})
+    endif()
+  endforeach()
+  math(EXPR ms "${best} / 1000")
+
+  execute_process(
+    COMMAND ${COMPILER} ${FLAGS} ${defines} -I${INCLUDE} -E ${source}
+            -o ${scratch}.ii)
+  file(SIZE ${scratch}.ii bytes)
+  math(EXPR kib "${bytes} / 1024")
+  set(${ms_var} ${ms} PARENT_SCOPE)
+  set(${kib_var} ${kib} PARENT_SCOPE)
+endfunction()
+
+set(csv "translation unit,mode,ms,preprocessed KiB\n")
+message("translation unit          mode        ms  preprocessed KiB")
+
+foreach(source ${SOURCES})
+  get_filename_component(name ${source} NAME)
+  foreach(mode full lean)
+    if(mode STREQUAL "lean")
+      set(defines -DADAPTEST_LEAN=1)
+    else()
+      set(defines -DADAPTEST_LEAN=0)
+    endif()
+    measure(${source} "${defines}" ms kib)
+    string(APPEND csv "${name},${mode},${ms},${kib}\n")
+    string(SUBSTRING "${name}                         " 0 25 column)
+    message("${column} ${mode}  ${ms}  ${kib}")
+  endforeach()
+endforeach()
+
+if(RUNNER)
+  get_filename_component(name ${RUNNER} NAME)
+  measure(${RUNNER} "-DADAPTEST_LEAN=1" ms kib)
+  string(APPEND csv "${name},runner,${ms},${kib}\n")
+  string(SUBSTRING "${name}                         " 0 25 column)
+  message("${column} runner  ${ms}  ${kib}")
+endif()
+
+file(REMOVE ${scratch}.o ${scratch}.ii)
+if(OUTPUT)
+  file(WRITE ${OUTPUT} "${csv}")
+endif()
@@ -0,0 +1,39 @@
+#include <adaptest.h>
+#include <adaptest/concurrent.h>
+#include <atomic>
+
+class SpecializedTestcase : public AdapTest::ConcurrentTestcase {
+public:
+	static const int nthreads = 4;
+	static const int iterations = 100000;
+	std::atomic<int> atomicCounter;
+	int racyCounter;
+	virtual void setUp() {
+		atomicCounter = 0;
+		racyCounter = 0;
+		concurrent_perturb = true;
+	}
+};
+
+TESTSUITE(ConcurrentCounters, SpecializedTestcase, "")
+	TESTCASE(AtomicCounter, "")
+		TEST(concurrent, nthreads, iterations, 
+			[&](AdapTest::ConcurrentContext&) {
+				int before = atomicCounter++;
+				CHECK(true, before >= 0, "before")
+			}, "increment")
+		TEST(eq, nthreads * iterations, atomicCounter.load(), "atomicCounter")
+	END_TESTCASE()
+	TESTCASE(RacyCounter, "")
+		// tests have to fail - we want it this way
+		TEST(concurrent, nthreads, iterations, 
+			[&](AdapTest::ConcurrentContext& ctx) {
+				int value = racyCounter;
+				ctx.perturb();
+				racyCounter = value + 1;
+			}, "increment")
+		TEST(eq, nthreads * iterations, racyCounter, "racyCounter")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
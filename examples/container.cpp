@@ -0,0 +1,49 @@
+#include <adaptest.h>
+#include <adaptest/container.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SpecializedTestcase : public AdapTest::ContainerTestcase {
+public:
+	std::vector<uint8_t> payload;
+	virtual void setUp() {
+		payload.resize(4 * 1024 * 1024);
+		for (size_t i = 0; i < payload.size(); ++i)
+		{
+			payload[i] = (uint8_t)(i * 7919 >> 3);
+		}
+	}
+};
+
+TESTSUITE(Containers, SpecializedTestcase, "")
+
+	// compared by memcmp
+	TESTCASE(Payload, "")
+		std::vector<uint8_t> copy(payload);
+		TEST(eq, payload, copy, "copy")
+	END_TESTCASE()
+
+	TESTCASE(CorruptedPayload, "only the changed bytes are reported")
+		std::vector<uint8_t> copy(payload);
+		copy[1000] ^= 0xff;
+		copy.insert(copy.begin() + 3000000, 42);
+		TEST(eq, payload, copy, "copy") // will fail
+	END_TESTCASE()
+
+	TESTCASE(Lines, "strings with newlines are diffed by lines")
+		const std::string expected = "alpha\nbeta\ngamma\ndelta\nepsilon\n";
+		const std::string value    = "alpha\nbeta\ngamma\nDELTA\nepsilon\n";
+		TEST(eq, expected, value, "text") // will fail
+	END_TESTCASE()
+
+	TESTCASE(Arrays, "")
+		const int expected[] = { 1, 2, 3, 4 };
+		const int value[]    = { 1, 2, 4 };
+		CHECK(eq, "abc", "abc", "literal")
+		CHECK(eq, expected, value, "array") // will fail
+	END_TESTCASE()
+
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
@@ -0,0 +1,35 @@
+#define ADAPTEST_BUFWRITE_FILE 1
+#include <adaptest.h>
+#include <adaptest/latency.h>
+#include <chrono>
+#include <map>
+#include <thread>
+
+using namespace std::chrono;
+
+class SpecializedTestcase :
+	public AdapTest::LatencyTestcase<AdapTest::CSVBufferWriter> {
+public:
+	std::map<int, int> table;
+	int calls;
+	virtual void setUp() {
+		calls = 0;
+		for (int i = 0; i < 1000; ++i) table[i] = i;
+	}
+};
+
+TESTSUITE(Latencies, SpecializedTestcase, "")
+	TESTCASE(Lookup, "")
+		TEST(latency, [&]() { table.find(calls++ % 1000); }, 100000,
+			microseconds(100), milliseconds(1), "lookup")
+	END_TESTCASE()
+	TESTCASE(Stalls, "")
+		// every 50th call stalls, the median is fine but the tail is not.
+		// tests have to fail - we want it this way
+		TEST(latency, [&]() {
+				if (++calls % 50 == 0) std::this_thread::sleep_for(milliseconds(1));
+			}, 1000, microseconds(100), microseconds(500), "stalls")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
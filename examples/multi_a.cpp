@@ -0,0 +1,12 @@
+#include <adaptest.h>
+
+// one of several translation units linked into the AdapTest_Multi executable
+
+class SpecializedTestcase : public AdapTest::Testcase {
+};
+
+TESTSUITE(FirstTestsuite, SpecializedTestcase, "defined in multi_a.cpp")
+	TESTCASE(Addition, "")
+		TEST(eq, 2, 1 + 1, "1 + 1")
+	END_TESTCASE()
+END_TESTSUITE()
@@ -0,0 +1,12 @@
+#include <adaptest.h>
+
+// one of several translation units linked into the AdapTest_Multi executable
+
+class OtherTestcase : public AdapTest::Testcase {
+};
+
+TESTSUITE(SecondTestsuite, OtherTestcase, "defined in multi_b.cpp")
+	TESTCASE(Subtraction, "")
+		TEST(eq, 0, 1 - 1, "1 - 1")
+	END_TESTCASE()
+END_TESTSUITE()
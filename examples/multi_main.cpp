@@ -0,0 +1,7 @@
+#include <adaptest.h>
+
+// the runner of the AdapTest_Multi executable. the testsuites are defined in
+// multi_a.cpp and multi_b.cpp. run with --list to see them or with
+// --suite <name> to run only one.
+
+ADAPTEST_MAIN(ConsoleLogger)
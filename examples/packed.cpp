@@ -0,0 +1,104 @@
+#define ADAPTEST_BUFWRITE_FILE 1
+#include <adaptest.h>
+#include <adaptest/packed.h>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// dumps buffers by PackedBufferWriter and decodes them again like
+// tools/unpack.cpp does
+class PackedTestcase : public virtual AdapTest::Testcase {
+public:
+	std::string packed_filename() {
+		return AdapTest::format(ADAPTEST_BUFWRITE_PACKED_FILENAME_FORMAT,
+			getTestsuite().getName(), getName());
+	}
+
+	template <class T>
+	AdapTest::Result test_roundtrip(
+		const std::vector<T>& buf, std::string name, const int line)
+	{
+		AdapTest::PackedBufferWriter<T> writer(line, *this);
+		writer.add_buf(buf.data(), buf.size(), name);
+		AdapTest::Result res = writer.write();
+		if (res != AdapTest::OK) return res;
+
+		AdapTest::PackedReader reader;
+		std::string err = reader.open(packed_filename());
+		std::stringstream csv;
+		if (err.empty()) err = reader.write_csv(csv);
+		if (!err.empty()) return AdapTest::Result(AdapTest::FAILED, name, line, err);
+
+		std::string header;
+		std::getline(csv, header);
+		for (size_t i = 0; i < buf.size(); ++i) {
+			T value = T();
+			csv >> value;
+			res = test_eq(buf[i], value, AdapTest::format("{}[{}]", name, i), line);
+			if (res != AdapTest::OK) return res;
+		}
+		return test_true(!(csv >> header), name + " has no more values", line);
+	}
+};
+
+TESTSUITE(Packed, PackedTestcase, "")
+
+	// spans several chunks
+	TESTCASE(Ints, "")
+		std::vector<int64_t> buf(100000);
+		for (size_t i = 0; i < buf.size(); ++i) {
+			buf[i] = (int64_t)(i * i) * (i % 3 ? 1 : -1);
+		}
+		buf[7] = INT64_MIN;
+		buf[8] = INT64_MAX;
+		TEST(roundtrip, buf, "ints")
+	END_TESTCASE()
+
+	TESTCASE(Floats, "")
+		std::vector<float> buf(100000);
+		for (size_t i = 0; i < buf.size(); ++i) {
+			buf[i] = std::sin(i * 0.001f) * (i % 100 ? 1.0f : 1e30f);
+		}
+		TEST(roundtrip, buf, "floats")
+	END_TESTCASE()
+
+	TESTCASE(Doubles, "")
+		std::vector<double> buf(100000, 0.25);
+		for (size_t i = 0; i < buf.size(); i += 7) buf[i] = std::exp(i * 1e-3);
+		TEST(roundtrip, buf, "doubles")
+	END_TESTCASE()
+
+	TESTCASE(Truncated, "a cut off file is reported")
+		std::vector<double> buf(1000);
+		for (size_t i = 0; i < buf.size(); ++i) buf[i] = std::sqrt((double)i);
+		AdapTest::PackedBufferWriter<double> writer(__LINE__, *this);
+		writer.add_buf(buf.data(), buf.size(), "doubles");
+		TEST(eq, AdapTest::OK, writer.write().resval, "written")
+
+		std::string bytes;
+		{
+			std::ifstream in(packed_filename().c_str(), std::ios::binary);
+			std::stringstream content;
+			content << in.rdbuf();
+			bytes = content.str();
+		}
+		{
+			std::ofstream out(packed_filename().c_str(), std::ios::binary);
+			out.write(bytes.data(), bytes.size() / 2);
+		}
+
+		AdapTest::PackedReader reader;
+		std::string err = reader.open(packed_filename());
+		if (err.empty()) {
+			std::stringstream csv;
+			err = reader.write_csv(csv);
+		}
+		TEST(false, err.empty(), "truncation reported")
+	END_TESTCASE()
+
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
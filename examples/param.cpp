@@ -0,0 +1,29 @@
+#include <adaptest.h>
+#include <adaptest/param.h>
+#include <cstdlib>
+
+struct AddCase {
+	int a, b, sum;
+};
+
+// the last row has to fail - we want it this way
+static const AddCase addCases[] = {
+	{ 1, 2, 3 },
+	{ 2, 2, 4 },
+	{ -1, 1, 0 },
+	{ 2, 2, 5 },
+};
+
+TESTSUITE(Parameters, AdapTest::Testcase, "")
+	TESTCASE_P(Add, "", AdapTest::param_array(addCases))
+		TEST(eq, param.sum, param.a + param.b, "sum")
+	END_TESTCASE()
+	// param.csv is copied next to the binary, run with --jobs to spread
+	// the rows over several threads
+	TESTCASE_P(Strtol, "", AdapTest::CsvTable("param.csv", true))
+		const long value = std::strtol(param["text"].c_str(), 0, 0);
+		TEST(eq, param.integer("value"), value, param["text"])
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
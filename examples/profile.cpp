@@ -0,0 +1,41 @@
+#include <adaptest.h>
+#include <adaptest/profile.h>
+#include <cmath>
+#include <vector>
+
+// writes Profile-Sort.folded and Profile-Math.folded, view them with
+// "flamegraph.pl Profile-Sort.folded > sort.svg" or speedscope
+class SpecializedTestcase : public AdapTest::Testcase {
+public:
+	std::vector<unsigned> data;
+	virtual void setUp() {
+		unsigned x = 12345;
+		data.resize(2000000);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = x = x * 1103515245 + 12345;
+	}
+	static void insertion(unsigned* begin, unsigned* end) {
+		for (unsigned* i = begin + 1; i < end; ++i) {
+			for (unsigned* j = i; j > begin && j[-1] > j[0]; --j) std::swap(j[-1], j[0]);
+		}
+	}
+	static double series(int n) {
+		double sum = 0;
+		for (int i = 1; i < n; ++i) sum += std::sin(i) / i;
+		return sum;
+	}
+};
+
+TESTSUITE(Profile, SpecializedTestcase, "")
+	TESTCASE(Sort, "")
+		// sort chunks by insertion sort, the hot spot
+		for (size_t i = 0; i + 1000 <= data.size(); i += 1000) {
+			insertion(&data[i], &data[i] + 1000);
+		}
+		TEST(true, data[0] <= data[1], "sorted")
+	END_TESTCASE()
+	TESTCASE(Math, "")
+		TEST(true, series(20000000) > 0, "series")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
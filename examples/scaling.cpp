@@ -0,0 +1,44 @@
+#define ADAPTEST_BUFWRITE_FILE 1
+#include <adaptest.h>
+#include <adaptest/scaling.h>
+#include <atomic>
+#include <thread>
+
+// counters on separate cache lines
+struct alignas(64) PaddedCounter {
+	std::atomic<long> value;
+};
+
+class SpecializedTestcase : public AdapTest::ScalingTestcase {
+public:
+	static const int iterations = 1000000;
+	size_t threads;
+	std::atomic<long> shared;
+	PaddedCounter padded[64];
+	virtual void setUp() {
+		threads = std::thread::hardware_concurrency();
+		if (threads > 64) threads = 64;
+		if (threads < 1) threads = 1;
+		shared = 0;
+		for (int i = 0; i < 64; ++i) padded[i].value = 0;
+	}
+};
+
+TESTSUITE(Scaling, SpecializedTestcase, "")
+	TESTCASE(PerThreadCounters, "")
+		TEST(scaling, threads, iterations,
+			[&](AdapTest::ConcurrentContext& ctx) {
+				padded[ctx.thread].value.fetch_add(1, std::memory_order_relaxed);
+			}, "padded")
+	END_TESTCASE()
+	TESTCASE(SharedCounter, "")
+		// all threads contend on one cache line, so on a multicore machine
+		// the efficiency drops and the test fails - we want it this way
+		TEST(scaling, threads, iterations,
+			[&](AdapTest::ConcurrentContext&) {
+				shared.fetch_add(1);
+			}, "shared")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
@@ -0,0 +1,39 @@
+#include <adaptest.h>
+#include <adaptest/serve.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// run "AdapTest_Serve --serve /tmp/adaptest.sock" once, then rerun the tests
+// with "adaptest-client /tmp/adaptest.sock [options]" from tools/. only the
+// first run pays for the fixture.
+class SpecializedTestcase : public AdapTest::Testcase {
+public:
+	static const std::vector<int>& primes() {
+		static std::vector<int> table = sieve(100000);
+		return table;
+	}
+	static std::vector<int> sieve(int n) {
+		// pretend this was expensive
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		std::vector<bool> composite(n + 1);
+		std::vector<int> found;
+		for (int i = 2; i <= n; ++i) {
+			if (composite[i]) continue;
+			found.push_back(i);
+			for (long j = (long)i * i; j <= n; j += i) composite[j] = true;
+		}
+		return found;
+	}
+};
+
+TESTSUITE(Primes, SpecializedTestcase, "")
+	TESTCASE(Count, "")
+		TEST(eq, 9592u, primes().size(), "primes below 100000")
+	END_TESTCASE()
+	TESTCASE(First, "")
+		TEST(eq, 2, primes()[0], "first prime")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
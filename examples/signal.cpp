@@ -0,0 +1,74 @@
+#define ADAPTEST_BUFWRITE_FILE 1
+#include <adaptest.h>
+#include <adaptest/buf.h>
+#include <adaptest/float.h>
+#include <adaptest/signal.h>
+#include <cstdint>
+#include <vector>
+
+using AdapTest::Signal;
+
+class SpecializedTestcase :
+	public AdapTest::FloatingPointTestcase,
+	public AdapTest::BufferTestcase<AdapTest::CSVBufferWriter> {
+public:
+	static const size_t buflen = 4096;
+	// generated by the first testcase, shared by all others
+	Signal<float> input;
+	Signal<float> noise;
+	virtual void setUp() {
+		input = AdapTest::signal_sine<float>(buflen, 0.01);
+		noise = AdapTest::signal_pink_noise<float>(buflen, 42, 0.1);
+	}
+};
+
+TESTSUITE(Signals, SpecializedTestcase, "")
+
+	TESTCASE(Gain, "")
+		std::vector<float> out(buflen);
+		for (size_t i = 0; i < buflen; ++i) out[i] = 2 * input[i];
+		Signal<float> expected = AdapTest::signal_sine<float>(buflen, 0.01, 2.0);
+		TEST(buf, buflen, &out[0], expected.data(), "gain")
+	END_TESTCASE()
+
+	TESTCASE(Noise, "pink noise stays within its amplitude")
+		bool bounded = true;
+		for (size_t i = 0; i < buflen; ++i)
+			bounded = bounded && noise[i] >= -0.1f && noise[i] < 0.1f;
+		TEST(true, bounded, "bounded")
+	END_TESTCASE()
+
+	TESTCASE(ImpulseResponse, "a FIR filter responds with its taps")
+		const float taps[] = { 0.25f, 0.5f, 0.25f };
+		Signal<float> impulse = AdapTest::signal_impulse<float>(16);
+		std::vector<float> out(impulse.size());
+		for (size_t i = 0; i < out.size(); ++i)
+			for (size_t t = 0; t < 3 && t <= i; ++t)
+				out[i] += taps[t] * impulse[i - t];
+		TEST(buf, 3, &out[0], taps, "response")
+	END_TESTCASE()
+
+	TESTCASE(RandomInts, "seeded integers are reproducible and in range")
+		Signal<int16_t> in =
+			AdapTest::signal_random_ints<int16_t>(buflen, 7, -1000, 1000);
+		bool inRange = true;
+		for (size_t i = 0; i < in.size(); ++i)
+			inRange = inRange && in[i] >= -1000 && in[i] <= 1000;
+		TEST(true, inRange, "in range")
+
+		// generated anew, not taken from the cache
+		const std::vector<int16_t> first = in.vector();
+		AdapTest::SignalCache::instance().clear();
+		Signal<int16_t> again =
+			AdapTest::signal_random_ints<int16_t>(buflen, 7, -1000, 1000);
+		TEST(true, again.data() != in.data(), "generated again")
+		TEST(buf, buflen, again.data(), &first[0], "same seed")
+
+		Signal<int16_t> other =
+			AdapTest::signal_random_ints<int16_t>(buflen, 8, -1000, 1000);
+		TEST(false, other.vector() == first, "other seed")
+	END_TESTCASE()
+
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
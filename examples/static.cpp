@@ -0,0 +1,41 @@
+#include <adaptest.h>
+#include <adaptest/static.h>
+#include <array>
+
+constexpr unsigned factorial(unsigned n) { return n < 2 ? 1 : n * factorial(n - 1); }
+
+constexpr unsigned popcount(unsigned x) {
+	unsigned count = 0;
+	for (; x; x &= x - 1) ++count;
+	return count;
+}
+
+// checked when compiling, costs nothing at runtime
+STATIC_ASSERT_TEST(eq, 120u, factorial(5), "factorial")
+
+class SpecializedTestcase : public AdapTest::Testcase {};
+
+TESTSUITE(Constexpr, SpecializedTestcase, "")
+
+	TESTCASE(Mixed, "a runtime testcase with compile time checks")
+		STATIC_ASSERT_TEST(eq, 3u, popcount(0x13), "popcount")
+		unsigned bits = 0xff;
+		TEST(eq, 8u, popcount(bits), "popcount(bits)")
+	END_TESTCASE()
+
+	// counted and logged as passed testcases
+	STATIC_TEST(false, factorial(3) == 7, "factorial(3) == 7")
+
+	// logged as passed, the checks failed the build otherwise
+	CONSTEXPR_TESTCASE(Popcount, "popcount of all bytes")
+		std::array<unsigned, 256> counts {};
+		for (unsigned i = 0; i < counts.size(); ++i) counts[i] = popcount(i);
+		unsigned total = 0;
+		for (unsigned c : counts) total += c;
+		CONSTEXPR_TEST(eq, 1024u, total, "total")
+		CONSTEXPR_TEST(true, counts[255] == 8, "counts[255] == 8")
+	END_CONSTEXPR_TESTCASE()
+
+END_TESTSUITE()
+
+ADAPTEST_MAIN(ConsoleLogger)
@@ -0,0 +1,33 @@
+#define ADAPTEST_BUFWRITE_FILE 1
+#include <adaptest.h>
+#include <adaptest/asyncwrite.h>
+#include <adaptest/param.h>
+#include <adaptest/trace.h>
+#include <chrono>
+#include <thread>
+
+// writes adaptest-trace.json, open it in https://ui.perfetto.dev or
+// chrome://tracing. run with --jobs 4 to see the rows on several threads.
+static const int delays[] = { 5, 20, 5, 5, 40, 5, 5, 10 };
+
+class SpecializedTestcase :
+	public AdapTest::BufferTestcase<AdapTest::AsyncCSVBufferWriter> {
+public:
+	int buf[100];
+	virtual void setUp() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		for (int i = 0; i < 100; ++i) buf[i] = i;
+	}
+};
+
+TESTSUITE(Timeline, SpecializedTestcase, "")
+	TESTCASE_P(Rows, "", AdapTest::param_array(delays))
+		std::this_thread::sleep_for(std::chrono::milliseconds(param));
+	END_TESTCASE()
+	TESTCASE(Dump, "")
+		// fails to show the artifact write - we want it this way
+		TEST(buf, buf, 1, "buf")
+	END_TESTCASE()
+END_TESTSUITE()
+
+ADAPTEST_MAIN(TraceLogger)
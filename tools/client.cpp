@@ -0,0 +1,79 @@
+// drives a test binary which runs with --serve <socket>
+//
+//   adaptest-client <socket> [options]   run with the usual options
+//   adaptest-client <socket> --quit      stop the server
+//
+// the results are printed by the ConsoleLogger, the exit code is the number
+// of failed tests as if the test binary was run directly.
+
+#include <adaptest.h>
+#include <adaptest/serve.h>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <socket> [--quit | options]"
+              << std::endl;
+    return 2;
+  }
+
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 
+      || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+    std::cerr << "could not connect to " << argv[1] << ": " 
+              << std::strerror(errno) << std::endl;
+    return 2;
+  }
+
+  std::string request = "run";
+  if (argc == 3 && std::string(argv[2]) == "--quit") {
+    request = "quit";
+  } else {
+    for (int i = 2; i < argc; ++i) {
+      request += '\t';
+      AdapTest::Record::escape(request, argv[i]);
+    }
+  }
+  request += '\n';
+  if (!AdapTest::write_all(fd, request)) {
+    std::cerr << "could not send the request" << std::endl;
+    return 2;
+  }
+  if (request == "quit\n") return 0;
+
+  AdapTest::LineReader reader(fd);
+  // created upon the first event, so --list prints no summary
+  std::unique_ptr<AdapTest::ConsoleLogger> logger;
+  std::unique_ptr<AdapTest::RecordReplay> replay;
+  std::string line;
+  while (reader.read(line)) {
+    AdapTest::Record record;
+    if (!record.decode(line)) continue;
+
+    if (record.type == 'D') return record.line;
+    if (record.type == 'L') {
+      std::cout << record.name << std::endl;
+    } else if (record.type == 'U') {
+      std::cerr << record.msg << std::endl;
+      return 2;
+    } else {
+      if (!logger) {
+        logger.reset(new AdapTest::ConsoleLogger());
+        replay.reset(new AdapTest::RecordReplay(*logger));
+      }
+      replay->replay(record);
+    }
+  }
+
+  std::cerr << "connection lost" << std::endl;
+  return 2;
+}
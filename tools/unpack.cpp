@@ -0,0 +1,45 @@
+// decodes buffer dumps written by AdapTest::PackedBufferWriter to CSV
+//
+//   adaptest-unpack <file.adpk> [file.csv]
+//
+// without a second argument the CSV is written to stdout.
+
+#include <adaptest.h>
+#include <adaptest/packed.h>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " <file.adpk> [file.csv]" << std::endl;
+    return 2;
+  }
+
+  AdapTest::PackedReader reader;
+  std::string err = reader.open(argv[1]);
+  if (!err.empty()) {
+    std::cerr << err << std::endl;
+    return 1;
+  }
+
+  bool written;
+  if (argc == 3) {
+    std::ofstream csv(argv[2]);
+    if (!csv.good()) {
+      std::cerr << "could not open " << argv[2] << std::endl;
+      return 1;
+    }
+    err = reader.write_csv(csv);
+    written = csv.good();
+  } else {
+    err = reader.write_csv(std::cout);
+    written = std::cout.good();
+  }
+
+  if (!err.empty()) {
+    std::cerr << err << std::endl;
+    return 1;
+  }
+  return written ? 0 : 1;
+}